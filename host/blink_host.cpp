@@ -0,0 +1,968 @@
+//
+// Headless reference host
+//
+// Loads a blink plugin, feeds it a synthetic stream of buffers and reports
+// how fast it ran. Only needs the C headers.
+//
+// Usage: blink_host <plugin> [options]
+//
+//   --seconds N     Length of audio to render (default 60)
+//   --sr N          Sample rate (default 44100)
+//   --units N       Number of units to process per instance, out of the
+//                   four which are created (default 1)
+//   --instances N   Number of instances (default 1)
+//   --vectors N     Vectors per process call. Uses the plugin's
+//                   blink_*_process_vectors() export when N > 1, if it
+//                   has one (default 1)
+//   --scenario S    linear, loop or scrub (default linear)
+//   --warp          Pass warp points to samplers
+//   --reactivate N  Deactivate and activate the processed units again
+//                   every N calls, in between process calls, if the plugin
+//                   exports blink_activate_unit() and
+//                   blink_deactivate_unit() (default 0, never)
+//   --trace PATH    Record a Chrome trace of the run to PATH, if the plugin
+//                   was built with BLINK_TRACE
+//   --batch         Process every synth unit with one call to the plugin's
+//                   blink_synth_process_batch() export per vector, if it
+//                   has one. All of the instances are put in the same
+//                   instance group
+//   --profile       Poll blink_get_profile_stats() for every processed unit
+//                   in between process calls, and fail if the plugin
+//                   doesn't account for exactly one record per vector
+//                   processed
+//
+// Units which aren't processed are deactivated. If the plugin exports
+// blink_set_parameter_generations() the units are given generation
+// counters, and one of the parameters is marked as changed every
+// PARAMETER_EDIT_INTERVAL calls.
+//
+// When built with BLINK_RT_CHECK=ON every process call is also checked for
+// allocations and mutex locks. See rt_check.hpp
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <blink.h>
+#include <blink_sampler.h>
+#include <blink_effect.h>
+#include <blink_synth.h>
+#include "rt_check.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace host {
+
+using Clock = std::chrono::steady_clock;
+
+//
+// Dynamic library
+//
+class Library
+{
+public:
+
+	bool open(const char* path)
+	{
+#ifdef _WIN32
+		handle_ = LoadLibraryA(path);
+#else
+		handle_ = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+#endif
+		return handle_ != nullptr;
+	}
+
+	~Library()
+	{
+		if (!handle_) return;
+#ifdef _WIN32
+		FreeLibrary(HMODULE(handle_));
+#else
+		dlclose(handle_);
+#endif
+	}
+
+	template <class T>
+	T get(const char* name) const
+	{
+#ifdef _WIN32
+		return reinterpret_cast<T>(GetProcAddress(HMODULE(handle_), name));
+#else
+		return reinterpret_cast<T>(dlsym(handle_, name));
+#endif
+	}
+
+	static std::string error()
+	{
+#ifdef _WIN32
+		return "error " + std::to_string(GetLastError());
+#else
+		const auto message = dlerror();
+
+		return message ? message : "unknown error";
+#endif
+	}
+
+private:
+
+	void* handle_ = nullptr;
+};
+
+struct API
+{
+	blink_Error (*init)() = nullptr;
+	blink_Error (*terminate)() = nullptr;
+	blink_Error (*stream_init)(blink_SR) = nullptr;
+	const char* (*get_plugin_name)() = nullptr;
+	int (*get_num_parameters)() = nullptr;
+	blink_Parameter (*get_parameter)(blink_Index) = nullptr;
+	blink_Error (*trace_begin)(const char*) = nullptr;
+	blink_Error (*trace_flush)() = nullptr;
+	blink_Error (*trace_end)() = nullptr;
+
+	blink_SamplerInstance (*make_sampler_instance)() = nullptr;
+	blink_Error (*destroy_sampler_instance)(blink_SamplerInstance) = nullptr;
+	blink_EffectInstance (*make_effect_instance)() = nullptr;
+	blink_Error (*destroy_effect_instance)(blink_EffectInstance) = nullptr;
+	blink_SynthInstance (*make_synth_instance)() = nullptr;
+	blink_Error (*destroy_synth_instance)(blink_SynthInstance) = nullptr;
+
+	// Optional
+	blink_Error (*sampler_process_vectors)(void*, const blink_SamplerBuffer*, blink_Index, float*) = nullptr;
+	blink_Error (*effect_process_vectors)(void*, const blink_EffectBuffer*, blink_Index, const float*, float*) = nullptr;
+	blink_Error (*synth_process_vectors)(void*, const blink_SynthBuffer*, blink_Index, float*) = nullptr;
+	blink_Error (*synth_process_batch)(blink_SynthJob*, blink_Index) = nullptr;
+	blink_Error (*get_profile_stats)(void*, blink_ProfileStats*) = nullptr;
+	blink_Error (*activate_unit)(void*) = nullptr;
+	blink_Error (*deactivate_unit)(void*) = nullptr;
+	blink_Error (*set_parameter_generations)(void*, const uint64_t*) = nullptr;
+
+	bool load(const Library& lib)
+	{
+		init = lib.get<decltype(init)>("blink_init");
+		terminate = lib.get<decltype(terminate)>("blink_terminate");
+		stream_init = lib.get<decltype(stream_init)>("blink_stream_init");
+		get_plugin_name = lib.get<decltype(get_plugin_name)>("blink_get_plugin_name");
+		get_num_parameters = lib.get<decltype(get_num_parameters)>("blink_get_num_parameters");
+		get_parameter = lib.get<decltype(get_parameter)>("blink_get_parameter");
+		trace_begin = lib.get<decltype(trace_begin)>("blink_trace_begin");
+		trace_flush = lib.get<decltype(trace_flush)>("blink_trace_flush");
+		trace_end = lib.get<decltype(trace_end)>("blink_trace_end");
+		make_sampler_instance = lib.get<decltype(make_sampler_instance)>("blink_make_sampler_instance");
+		destroy_sampler_instance = lib.get<decltype(destroy_sampler_instance)>("blink_destroy_sampler_instance");
+		make_effect_instance = lib.get<decltype(make_effect_instance)>("blink_make_effect_instance");
+		destroy_effect_instance = lib.get<decltype(destroy_effect_instance)>("blink_destroy_effect_instance");
+		make_synth_instance = lib.get<decltype(make_synth_instance)>("blink_make_synth_instance");
+		destroy_synth_instance = lib.get<decltype(destroy_synth_instance)>("blink_destroy_synth_instance");
+		sampler_process_vectors = lib.get<decltype(sampler_process_vectors)>("blink_sampler_process_vectors");
+		effect_process_vectors = lib.get<decltype(effect_process_vectors)>("blink_effect_process_vectors");
+		synth_process_vectors = lib.get<decltype(synth_process_vectors)>("blink_synth_process_vectors");
+		synth_process_batch = lib.get<decltype(synth_process_batch)>("blink_synth_process_batch");
+		get_profile_stats = lib.get<decltype(get_profile_stats)>("blink_get_profile_stats");
+		activate_unit = lib.get<decltype(activate_unit)>("blink_activate_unit");
+		deactivate_unit = lib.get<decltype(deactivate_unit)>("blink_deactivate_unit");
+		set_parameter_generations = lib.get<decltype(set_parameter_generations)>("blink_set_parameter_generations");
+
+		return init && terminate && stream_init && get_num_parameters && get_parameter;
+	}
+};
+
+struct Options
+{
+	const char* plugin = nullptr;
+	double seconds = 60.0;
+	blink_SR SR = 44100;
+	int units = 1;
+	int instances = 1;
+	int vectors = 1;
+	int reactivate = 0;
+	std::string scenario = "linear";
+	const char* trace = nullptr;
+	bool warp = false;
+	bool batch = false;
+	bool profile = false;
+};
+
+//
+// Synthetic parameter data. Envelopes ramp between the default min and max
+// values over a few seconds so that the plugin has to actually search them
+//
+class Parameters
+{
+public:
+
+	void make(const API& api, blink_SR SR)
+	{
+		const auto count = api.get_num_parameters();
+
+		data_.resize(count);
+		points_.resize(count);
+		options_.resize(count);
+		generations_.resize(count, 0);
+
+		for (int i = 0; i < count; i++)
+		{
+			const auto parameter = api.get_parameter(blink_Index(i));
+
+			auto& data = data_[i];
+
+			std::memset(&data, 0, sizeof(data));
+
+			data.type = parameter.parameter.type;
+
+			switch (parameter.parameter.type)
+			{
+				case blink_ParameterType_Envelope:
+				{
+					const auto& envelope = parameter.parameter.envelope;
+					const auto min = envelope.min.default_value;
+					const auto max = envelope.max.default_value;
+
+					for (int p = 0; p < 16; p++)
+					{
+						blink_EnvelopePoint point;
+
+						point.position.x = blink_IntPosition(p * int(SR));
+						point.position.y = (p % 2 == 0) ? envelope.default_value : min + ((max - min) * float(p % 5) / 4.0f);
+						point.curve = 0.0f;
+
+						points_[i].push_back(point);
+					}
+
+					options_[i].resize(std::max(envelope.options_count, 1), 0);
+
+					data.envelope.type = blink_ParameterType_Envelope;
+					data.envelope.points.count = blink_Index(points_[i].size());
+					data.envelope.points.points = points_[i].data();
+					data.envelope.options = options_[i].data();
+					data.envelope.min = min;
+					data.envelope.max = max;
+					break;
+				}
+
+				case blink_ParameterType_Option:
+				{
+					data.option.index = parameter.parameter.option.default_index;
+					break;
+				}
+
+				case blink_ParameterType_Slider:
+				{
+					data.slider.value = parameter.parameter.slider.slider.default_value;
+					break;
+				}
+
+				case blink_ParameterType_IntSlider:
+				{
+					data.int_slider.value = parameter.parameter.int_slider.slider.default_value;
+					break;
+				}
+
+				case blink_ParameterType_Toggle:
+				{
+					data.toggle.value = parameter.parameter.toggle.default_value;
+					break;
+				}
+
+				case blink_ParameterType_Chord:
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	blink_ParameterData* data() { return data_.empty() ? nullptr : data_.data(); }
+
+	// See blink_set_parameter_generations()
+	const std::uint64_t* generations() const { return generations_.empty() ? nullptr : generations_.data(); }
+
+	// As if the user had edited the parameter. The data stays the same
+	void touch(std::size_t index)
+	{
+		if (generations_.empty()) return;
+
+		generations_[index % generations_.size()]++;
+	}
+
+private:
+
+	std::vector<blink_ParameterData> data_;
+	std::vector<std::uint64_t> generations_;
+	std::vector<std::vector<blink_EnvelopePoint>> points_;
+	std::vector<std::vector<blink_Index>> options_;
+};
+
+//
+// Block positions for each scenario
+//
+class Positions
+{
+public:
+
+	Positions(const Options& options)
+		: scenario_(options.scenario)
+		, loop_length_(double(options.SR) * 2.0)
+		, scrub_interval_(16)
+		, scrub_range_(double(options.SR) * 8.0)
+	{
+	}
+
+	void fill(std::uint64_t vector_index, blink_Position* out)
+	{
+		for (int i = 0; i < BLINK_VECTOR_SIZE; i++)
+		{
+			const auto frame = blink_Position(vector_index * BLINK_VECTOR_SIZE + i);
+
+			if (scenario_ == "loop")
+			{
+				out[i] = std::fmod(frame, loop_length_);
+			}
+			else if (scenario_ == "scrub")
+			{
+				if (i == 0 && vector_index % scrub_interval_ == 0)
+				{
+					scrub_offset_ = std::uniform_real_distribution<double>(0.0, scrub_range_)(rng_) - frame;
+				}
+
+				out[i] = frame + scrub_offset_;
+			}
+			else
+			{
+				out[i] = frame;
+			}
+		}
+	}
+
+private:
+
+	std::string scenario_;
+	double loop_length_;
+	std::uint64_t scrub_interval_;
+	double scrub_range_;
+	double scrub_offset_ = 0.0;
+	std::mt19937 rng_ { 1 };
+};
+
+//
+// Sample data for samplers. A couple of sine waves
+//
+blink_FrameCount get_sample_data(void* host, blink_ChannelCount channel, blink_FrameCount index, blink_FrameCount size, float* buffer)
+{
+	const auto SR = *static_cast<blink_SR*>(host);
+
+	for (blink_FrameCount i = 0; i < size; i++)
+	{
+		const auto t = double(index + i) / double(SR);
+
+		buffer[i] = float(0.5 * std::sin(t * 440.0 * 6.283185307179586 * (channel + 1)));
+	}
+
+	return size;
+}
+
+//
+// Timing
+//
+struct Stats
+{
+	std::vector<double> call_ns;
+	std::vector<double> unit_ns;
+	double total_ns = 0.0;
+	int errors = 0;
+
+	void add(int unit, double ns)
+	{
+		call_ns.push_back(ns);
+		unit_ns[unit] += ns;
+		total_ns += ns;
+	}
+
+	// A batch call is shared out evenly between the units it processed
+	void add_batch(int num_units, double ns)
+	{
+		for (int unit = 0; unit < num_units; unit++) add(unit, ns / double(num_units));
+	}
+
+	double percentile(double p) const
+	{
+		if (call_ns.empty()) return 0.0;
+
+		auto sorted = call_ns;
+
+		std::sort(sorted.begin(), sorted.end());
+
+		return sorted[std::min(sorted.size() - 1, std::size_t(p * double(sorted.size())))];
+	}
+};
+
+//
+// Times one process call. This is also where the realtime-safety checker
+// (if enabled) starts and stops watching
+//
+template <class Fn>
+double time_ns(Fn&& fn)
+{
+	const auto beg = Clock::now();
+
+	{
+		rt_check::Scope rt_scope;
+
+		fn();
+	}
+
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - beg).count());
+}
+
+//
+// One block's worth of units. Four are always created, like Blockhead
+// does for crossfading, but only the first [Options::units] are processed
+//
+struct UnitSet
+{
+	std::vector<blink_SamplerUnit> sampler;
+	std::vector<blink_EffectUnit> effect;
+	std::vector<blink_SynthUnit> synth;
+
+	void* proc_data(int index) const
+	{
+		if (!sampler.empty()) return sampler[index].proc_data;
+		if (!effect.empty()) return effect[index].proc_data;
+
+		return synth[index].proc_data;
+	}
+};
+
+constexpr std::uint64_t PARAMETER_EDIT_INTERVAL = 64;
+
+// Well within the capacity of the plugin's profile ring buffers
+constexpr std::uint64_t PROFILE_POLL_INTERVAL = 32;
+
+//
+// Profile records collected from each processed unit (see --profile)
+//
+struct ProfileCounts
+{
+	std::vector<std::uint64_t> num_calls;
+	std::uint64_t num_dropped = 0;
+
+	void poll(const API& api, const std::vector<UnitSet>& unit_sets, int active_units)
+	{
+		for (std::size_t i = 0; i < unit_sets.size(); i++)
+		{
+			for (int u = 0; u < active_units; u++)
+			{
+				blink_ProfileStats stats;
+
+				if (api.get_profile_stats(unit_sets[i].proc_data(u), &stats) != BLINK_OK) continue;
+
+				num_calls[(i * active_units) + u] += stats.num_calls;
+				num_dropped += stats.num_dropped;
+			}
+		}
+	}
+};
+
+int run(const Options& options)
+{
+	rt_check::init();
+
+	Library lib;
+
+	if (!lib.open(options.plugin))
+	{
+		std::fprintf(stderr, "Failed to load %s: %s\n", options.plugin, Library::error().c_str());
+		return 1;
+	}
+
+	API api;
+
+	if (!api.load(lib))
+	{
+		std::fprintf(stderr, "%s is not a blink plugin\n", options.plugin);
+		return 1;
+	}
+
+	const auto is_sampler = api.make_sampler_instance != nullptr;
+	const auto is_effect = !is_sampler && api.make_effect_instance != nullptr;
+	const auto is_synth = !is_sampler && !is_effect && api.make_synth_instance != nullptr;
+
+	if (!is_sampler && !is_effect && !is_synth)
+	{
+		std::fprintf(stderr, "%s doesn't export any instance type\n", options.plugin);
+		return 1;
+	}
+
+	api.init();
+
+	auto SR = options.SR;
+
+	api.stream_init(SR);
+
+	Parameters parameters;
+
+	parameters.make(api, SR);
+
+	std::vector<blink_SamplerInstance> sampler_instances;
+	std::vector<blink_EffectInstance> effect_instances;
+	std::vector<blink_SynthInstance> synth_instances;
+	std::vector<UnitSet> unit_sets(options.instances);
+
+	for (int i = 0; i < options.instances; i++)
+	{
+		for (int u = 0; u < 4; u++)
+		{
+			if (is_sampler)
+			{
+				if (u == 0) sampler_instances.push_back(api.make_sampler_instance());
+
+				unit_sets[i].sampler.push_back(sampler_instances.back().add_unit(sampler_instances.back().proc_data));
+			}
+			else if (is_effect)
+			{
+				if (u == 0) effect_instances.push_back(api.make_effect_instance());
+
+				unit_sets[i].effect.push_back(effect_instances.back().add_unit(effect_instances.back().proc_data));
+			}
+			else
+			{
+				if (u == 0) synth_instances.push_back(api.make_synth_instance());
+
+				unit_sets[i].synth.push_back(synth_instances.back().add_unit(synth_instances.back().proc_data));
+			}
+		}
+	}
+
+	//
+	// Buffers
+	//
+	const auto num_vectors = std::max(1, options.vectors);
+	const auto frames_per_call = std::size_t(BLINK_VECTOR_SIZE) * num_vectors;
+
+	std::vector<blink_Position> positions(frames_per_call);
+	std::vector<float> in(frames_per_call * 2);
+	std::vector<float> out(frames_per_call * 2);
+
+	for (std::size_t i = 0; i < frames_per_call; i++)
+	{
+		in[i] = in[frames_per_call + i] = float(std::sin(double(i) * 0.05));
+	}
+
+	blink_SampleInfo sample_info {};
+
+	sample_info.id = 1;
+	sample_info.num_channels = 2;
+	sample_info.num_frames = blink_FrameCount(SR) * 10;
+	sample_info.SR = SR;
+	sample_info.bit_depth = 32;
+	sample_info.analysis_ready = BLINK_TRUE;
+	sample_info.host = &SR;
+	sample_info.get_data = get_sample_data;
+
+	std::vector<blink_WarpPoint> warp_point_data = {
+		{ 0, 0, 0.0f },
+		{ blink_IntPosition(SR), blink_IntPosition(SR) / 2, 0.0f },
+		{ blink_IntPosition(SR) * 4, blink_IntPosition(SR) * 5, 0.0f },
+	};
+
+	blink_WarpPoints warp_points { blink_Index(warp_point_data.size()), warp_point_data.data() };
+
+	//
+	// Tracing. Events are flushed to the file from a separate thread while
+	// processing, as a real host would
+	//
+	std::atomic<bool> tracing { false };
+	std::thread trace_thread;
+
+	if (options.trace)
+	{
+		if (!api.trace_begin || !api.trace_flush || !api.trace_end)
+		{
+			std::fprintf(stderr, "%s doesn't support tracing\n", options.plugin);
+		}
+		else if (api.trace_begin(options.trace) != BLINK_OK)
+		{
+			std::fprintf(stderr, "Failed to start tracing to %s (was the plugin built with BLINK_TRACE?)\n", options.trace);
+		}
+		else
+		{
+			tracing = true;
+
+			trace_thread = std::thread([&api, &tracing]()
+			{
+				while (tracing)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+					api.trace_flush();
+				}
+			});
+		}
+	}
+
+	Positions position_gen(options);
+	Stats stats;
+
+	const auto active_units = std::clamp(options.units, 1, 4);
+	const auto can_reactivate = api.activate_unit && api.deactivate_unit;
+
+	for (const auto& unit_set : unit_sets)
+	{
+		for (int u = 0; u < 4; u++)
+		{
+			const auto proc_data = unit_set.proc_data(u);
+
+			if (api.set_parameter_generations) api.set_parameter_generations(proc_data, parameters.generations());
+			if (u >= active_units && can_reactivate) api.deactivate_unit(proc_data);
+		}
+	}
+
+	stats.unit_ns.resize(std::size_t(options.instances) * active_units, 0.0);
+
+	const auto batch = is_synth && options.batch && api.synth_process_batch;
+
+	if (options.batch && !batch)
+	{
+		std::fprintf(stderr, "%s doesn't export blink_synth_process_batch()\n", options.plugin);
+	}
+
+	//
+	// One job per processed unit, each with its own output, since the
+	// plugin may work on all of them at once
+	//
+	const auto num_jobs = options.instances * active_units;
+
+	std::vector<blink_SynthBuffer> batch_buffers(batch ? options.instances : 0);
+	std::vector<blink_SynthJob> batch_jobs(batch ? num_jobs : 0);
+	std::vector<float> batch_out(batch ? std::size_t(num_jobs) * BLINK_VECTOR_SIZE * 2 : 0);
+
+	for (int i = 0; i < int(batch_buffers.size()); i++)
+	{
+		auto& buffer = batch_buffers[i];
+
+		buffer = blink_SynthBuffer();
+		buffer.instance_group = 0;
+		buffer.song_rate = SR;
+		buffer.parameter_data = parameters.data();
+
+		for (int u = 0; u < active_units; u++)
+		{
+			auto& job = batch_jobs[(i * active_units) + u];
+
+			job.proc_data = unit_sets[i].synth[u].proc_data;
+			job.buffer = &buffer;
+			job.out = batch_out.data() + (std::size_t((i * active_units) + u) * BLINK_VECTOR_SIZE * 2);
+		}
+	}
+
+	const auto profile = options.profile && api.get_profile_stats;
+
+	if (options.profile && !profile)
+	{
+		std::fprintf(stderr, "%s doesn't export blink_get_profile_stats()\n", options.plugin);
+	}
+
+	ProfileCounts profile_counts;
+
+	profile_counts.num_calls.resize(std::size_t(num_jobs), 0);
+
+	// Throw away anything recorded before the run
+	if (profile) profile_counts.poll(api, unit_sets, active_units);
+
+	std::fill(profile_counts.num_calls.begin(), profile_counts.num_calls.end(), 0);
+
+	const auto total_vectors = std::uint64_t(options.seconds * double(SR) / BLINK_VECTOR_SIZE);
+	const auto total_calls = (total_vectors + num_vectors - 1) / num_vectors;
+
+	for (std::uint64_t call = 0; call < total_calls; call++)
+	{
+		const auto first_vector = call * num_vectors;
+
+		for (int v = 0; v < num_vectors; v++)
+		{
+			position_gen.fill(first_vector + v, positions.data() + (v * BLINK_VECTOR_SIZE));
+		}
+
+		const auto buffer_id = first_vector + 1;
+
+		//
+		// Everything which a host would do from its UI thread happens here,
+		// in between process calls and outside of the realtime check
+		//
+		if (call > 0 && call % PARAMETER_EDIT_INTERVAL == 0)
+		{
+			parameters.touch(call / PARAMETER_EDIT_INTERVAL);
+		}
+
+		if (profile && call % PROFILE_POLL_INTERVAL == 0)
+		{
+			profile_counts.poll(api, unit_sets, active_units);
+		}
+
+		if (options.reactivate > 0 && call > 0 && call % options.reactivate == 0 && can_reactivate)
+		{
+			for (const auto& unit_set : unit_sets)
+			{
+				for (int u = 0; u < active_units; u++)
+				{
+					api.deactivate_unit(unit_set.proc_data(u));
+					api.activate_unit(unit_set.proc_data(u));
+				}
+			}
+		}
+
+		if (batch)
+		{
+			blink_Error result = BLINK_OK;
+
+			stats.add_batch(num_jobs, time_ns([&]()
+			{
+				for (int v = 0; v < num_vectors; v++)
+				{
+					for (auto& buffer : batch_buffers)
+					{
+						buffer.buffer_id = buffer_id + v;
+						buffer.positions = positions.data() + (v * BLINK_VECTOR_SIZE);
+					}
+
+					result |= api.synth_process_batch(batch_jobs.data(), blink_Index(num_jobs));
+				}
+			}));
+
+			if (result != BLINK_OK) stats.errors++;
+
+			continue;
+		}
+
+		for (int i = 0; i < options.instances; i++)
+		{
+			for (int u = 0; u < active_units; u++)
+			{
+				const auto stat_index = (i * active_units) + u;
+
+				blink_Error result = BLINK_OK;
+
+				if (is_sampler)
+				{
+					blink_SamplerBuffer buffer {};
+
+					buffer.buffer_id = buffer_id;
+					buffer.song_rate = SR;
+					buffer.channel_mode = blink_ChannelMode_Stereo;
+					buffer.sample_info = &sample_info;
+					buffer.positions = positions.data();
+					buffer.warp_points = options.warp ? &warp_points : nullptr;
+					buffer.parameter_data = parameters.data();
+
+					const auto& unit = unit_sets[i].sampler[u];
+
+					stats.add(stat_index, time_ns([&]()
+					{
+						if (num_vectors > 1 && api.sampler_process_vectors)
+						{
+							result = api.sampler_process_vectors(unit.proc_data, &buffer, blink_Index(num_vectors), out.data());
+						}
+						else for (int v = 0; v < num_vectors; v++)
+						{
+							buffer.buffer_id = buffer_id + v;
+							buffer.positions = positions.data() + (v * BLINK_VECTOR_SIZE);
+
+							result |= unit.process(unit.proc_data, &buffer, out.data() + (v * BLINK_VECTOR_SIZE * 2));
+						}
+					}));
+				}
+				else if (is_effect)
+				{
+					blink_EffectBuffer buffer {};
+
+					buffer.buffer_id = buffer_id;
+					buffer.song_rate = SR;
+					buffer.positions = positions.data();
+					buffer.parameter_data = parameters.data();
+
+					const auto& unit = unit_sets[i].effect[u];
+
+					stats.add(stat_index, time_ns([&]()
+					{
+						if (num_vectors > 1 && api.effect_process_vectors)
+						{
+							result = api.effect_process_vectors(unit.proc_data, &buffer, blink_Index(num_vectors), in.data(), out.data());
+						}
+						else for (int v = 0; v < num_vectors; v++)
+						{
+							buffer.buffer_id = buffer_id + v;
+							buffer.positions = positions.data() + (v * BLINK_VECTOR_SIZE);
+
+							const auto offset = v * BLINK_VECTOR_SIZE * 2;
+
+							result |= unit.process(unit.proc_data, &buffer, in.data() + offset, out.data() + offset);
+						}
+					}));
+				}
+				else
+				{
+					blink_SynthBuffer buffer {};
+
+					buffer.buffer_id = buffer_id;
+					buffer.song_rate = SR;
+					buffer.positions = positions.data();
+					buffer.parameter_data = parameters.data();
+
+					const auto& unit = unit_sets[i].synth[u];
+
+					stats.add(stat_index, time_ns([&]()
+					{
+						if (num_vectors > 1 && api.synth_process_vectors)
+						{
+							result = api.synth_process_vectors(unit.proc_data, &buffer, blink_Index(num_vectors), out.data());
+						}
+						else for (int v = 0; v < num_vectors; v++)
+						{
+							buffer.buffer_id = buffer_id + v;
+							buffer.positions = positions.data() + (v * BLINK_VECTOR_SIZE);
+
+							result |= unit.process(unit.proc_data, &buffer, out.data() + (v * BLINK_VECTOR_SIZE * 2));
+						}
+					}));
+				}
+
+				if (result != BLINK_OK) stats.errors++;
+			}
+		}
+	}
+
+	const auto traced = trace_thread.joinable();
+
+	std::uint64_t num_profiled = 0;
+	int num_profile_errors = 0;
+
+	if (profile)
+	{
+		profile_counts.poll(api, unit_sets, active_units);
+
+		for (const auto count : profile_counts.num_calls)
+		{
+			num_profiled += count;
+
+			if (count + profile_counts.num_dropped < total_calls * num_vectors) num_profile_errors++;
+			if (count > total_calls * num_vectors) num_profile_errors++;
+		}
+	}
+
+	if (traced)
+	{
+		tracing = false;
+
+		trace_thread.join();
+
+		api.trace_end();
+	}
+
+	//
+	// Report
+	//
+	const auto audio_ns = double(total_calls * frames_per_call) / double(SR) * 1.0e9;
+
+	std::printf("plugin:          %s\n", api.get_plugin_name ? api.get_plugin_name() : options.plugin);
+	std::printf("type:            %s\n", is_sampler ? "sampler" : is_effect ? "effect" : "synth");
+	std::printf("scenario:        %s%s\n", options.scenario.c_str(), options.warp ? " (warp)" : "");
+	std::printf("instances:       %d x %d unit(s)\n", options.instances, active_units);
+	std::printf("vectors/call:    %d%s\n", num_vectors, batch ? " (batched)" : "");
+	std::printf("audio:           %.2f s\n", audio_ns * 1.0e-9);
+	std::printf("processing:      %.3f s\n", stats.total_ns * 1.0e-9);
+	std::printf("realtime factor: %.1fx\n", audio_ns / std::max(stats.total_ns, 1.0));
+	std::printf("call latency:    p50 %.0f ns, p90 %.0f ns, p99 %.0f ns, max %.0f ns\n",
+		stats.percentile(0.5), stats.percentile(0.9), stats.percentile(0.99), stats.percentile(1.0));
+
+	double max_unit_ns = 0.0;
+
+	for (const auto ns : stats.unit_ns) max_unit_ns = std::max(max_unit_ns, ns);
+
+	std::printf("cpu per unit:    %.3f%% average, %.3f%% max\n",
+		100.0 * (stats.total_ns / double(stats.unit_ns.size())) / audio_ns,
+		100.0 * max_unit_ns / audio_ns);
+
+	if (traced)
+	{
+		std::printf("trace:           %s\n", options.trace);
+	}
+
+	if (profile)
+	{
+		std::printf("profiled calls:  %llu, %llu dropped\n", (unsigned long long)(num_profiled), (unsigned long long)(profile_counts.num_dropped));
+	}
+
+	if (num_profile_errors > 0)
+	{
+		std::printf("profile errors:  %d unit(s) with the wrong number of records\n", num_profile_errors);
+	}
+
+	if (rt_check::ENABLED)
+	{
+		std::printf("realtime check:  passed\n");
+	}
+
+	if (stats.errors > 0)
+	{
+		std::printf("errors:          %d\n", stats.errors);
+	}
+
+	for (auto instance : sampler_instances) api.destroy_sampler_instance(instance);
+	for (auto instance : effect_instances) api.destroy_effect_instance(instance);
+	for (auto instance : synth_instances) api.destroy_synth_instance(instance);
+
+	api.terminate();
+
+	return stats.errors > 0 || num_profile_errors > 0 ? 2 : 0;
+}
+
+} // host
+
+int main(int argc, char** argv)
+{
+	host::Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (arg == "--seconds") options.seconds = std::atof(next());
+		else if (arg == "--sr") options.SR = blink_SR(std::atoi(next()));
+		else if (arg == "--units") options.units = std::atoi(next());
+		else if (arg == "--instances") options.instances = std::max(1, std::atoi(next()));
+		else if (arg == "--vectors") options.vectors = std::atoi(next());
+		else if (arg == "--scenario") options.scenario = next();
+		else if (arg == "--warp") options.warp = true;
+		else if (arg == "--reactivate") options.reactivate = std::max(0, std::atoi(next()));
+		else if (arg == "--trace") options.trace = next();
+		else if (arg == "--batch") options.batch = true;
+		else if (arg == "--profile") options.profile = true;
+		else if (!options.plugin) options.plugin = argv[i];
+		else
+		{
+			std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	if (!options.plugin)
+	{
+		std::fprintf(stderr, "Usage: blink_host <plugin> [--seconds N] [--sr N] [--units N] [--instances N] [--vectors N] [--scenario linear|loop|scrub] [--warp] [--reactivate N] [--trace PATH] [--batch] [--profile]\n");
+		return 1;
+	}
+
+	return host::run(options);
+}
@@ -0,0 +1,340 @@
+#include "rt_check.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !defined(__GLIBC__)
+#error The realtime-safety checker requires glibc
+#endif
+
+// The clockid_t variants of the timed waits, which libstdc++ uses for
+// steady_clock timeouts
+#define BLINK_RT_CHECK_CLOCK_WAITS __GLIBC_PREREQ(2, 30)
+
+//
+// The allocator glibc would have used if we hadn't replaced it
+//
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void* __libc_valloc(std::size_t size);
+void* __libc_pvalloc(std::size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace host {
+namespace rt_check {
+
+namespace {
+
+using MutexFn = int(*)(pthread_mutex_t*);
+using MutexTimedFn = int(*)(pthread_mutex_t*, const timespec*);
+using RwlockFn = int(*)(pthread_rwlock_t*);
+using RwlockTimedFn = int(*)(pthread_rwlock_t*, const timespec*);
+using SemFn = int(*)(sem_t*);
+using SemTimedFn = int(*)(sem_t*, const timespec*);
+using MutexClockFn = int(*)(pthread_mutex_t*, clockid_t, const timespec*);
+using RwlockClockFn = int(*)(pthread_rwlock_t*, clockid_t, const timespec*);
+using SemClockFn = int(*)(sem_t*, clockid_t, const timespec*);
+
+thread_local int depth = 0;
+
+MutexFn real_mutex_lock = nullptr;
+MutexFn real_mutex_trylock = nullptr;
+MutexTimedFn real_mutex_timedlock = nullptr;
+RwlockFn real_rwlock_rdlock = nullptr;
+RwlockFn real_rwlock_wrlock = nullptr;
+RwlockFn real_rwlock_tryrdlock = nullptr;
+RwlockFn real_rwlock_trywrlock = nullptr;
+RwlockTimedFn real_rwlock_timedrdlock = nullptr;
+RwlockTimedFn real_rwlock_timedwrlock = nullptr;
+SemFn real_sem_wait = nullptr;
+SemFn real_sem_trywait = nullptr;
+SemTimedFn real_sem_timedwait = nullptr;
+MutexClockFn real_mutex_clocklock = nullptr;
+RwlockClockFn real_rwlock_clockrdlock = nullptr;
+RwlockClockFn real_rwlock_clockwrlock = nullptr;
+SemClockFn real_sem_clockwait = nullptr;
+
+void write_stderr(const char* str)
+{
+	const auto result = ::write(STDERR_FILENO, str, std::strlen(str));
+
+	(void)(result);
+}
+
+// Nothing in here may allocate
+[[noreturn]] void violation(const char* fn)
+{
+	depth = 0;
+
+	write_stderr("\n*** realtime violation: ");
+	write_stderr(fn);
+	write_stderr("() called from inside a process function ***\n\n");
+
+	void* frames[64];
+
+	const auto count = backtrace(frames, 64);
+
+	backtrace_symbols_fd(frames, count, STDERR_FILENO);
+
+	write_stderr("\n");
+
+	std::abort();
+}
+
+inline void check(const char* fn)
+{
+	if (depth > 0) violation(fn);
+}
+
+template <class Fn>
+Fn resolve(Fn& fn, const char* name)
+{
+	if (!fn) fn = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+
+	return fn;
+}
+
+}
+
+void init()
+{
+	resolve(real_mutex_lock, "pthread_mutex_lock");
+	resolve(real_mutex_trylock, "pthread_mutex_trylock");
+	resolve(real_mutex_timedlock, "pthread_mutex_timedlock");
+	resolve(real_rwlock_rdlock, "pthread_rwlock_rdlock");
+	resolve(real_rwlock_wrlock, "pthread_rwlock_wrlock");
+	resolve(real_rwlock_tryrdlock, "pthread_rwlock_tryrdlock");
+	resolve(real_rwlock_trywrlock, "pthread_rwlock_trywrlock");
+	resolve(real_rwlock_timedrdlock, "pthread_rwlock_timedrdlock");
+	resolve(real_rwlock_timedwrlock, "pthread_rwlock_timedwrlock");
+	resolve(real_sem_wait, "sem_wait");
+	resolve(real_sem_trywait, "sem_trywait");
+	resolve(real_sem_timedwait, "sem_timedwait");
+#if BLINK_RT_CHECK_CLOCK_WAITS
+	resolve(real_mutex_clocklock, "pthread_mutex_clocklock");
+	resolve(real_rwlock_clockrdlock, "pthread_rwlock_clockrdlock");
+	resolve(real_rwlock_clockwrlock, "pthread_rwlock_clockwrlock");
+	resolve(real_sem_clockwait, "sem_clockwait");
+#endif
+
+	// The first call to backtrace() loads libgcc, which allocates. Get it
+	// out of the way now so that it doesn't happen while reporting
+	void* frame;
+
+	backtrace(&frame, 1);
+}
+
+Scope::Scope()
+{
+	depth++;
+}
+
+Scope::~Scope()
+{
+	depth--;
+}
+
+}}
+
+using host::rt_check::check;
+using host::rt_check::resolve;
+
+extern "C" {
+
+void* malloc(std::size_t size)
+{
+	check("malloc");
+
+	return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size)
+{
+	check("calloc");
+
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size)
+{
+	check("realloc");
+
+	return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+	if (ptr) check("free");
+
+	__libc_free(ptr);
+}
+
+void* memalign(std::size_t alignment, std::size_t size)
+{
+	check("memalign");
+
+	return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+	check("aligned_alloc");
+
+	return __libc_memalign(alignment, size);
+}
+
+void* valloc(std::size_t size)
+{
+	check("valloc");
+
+	return __libc_valloc(size);
+}
+
+void* pvalloc(std::size_t size)
+{
+	check("pvalloc");
+
+	return __libc_pvalloc(size);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size)
+{
+	check("posix_memalign");
+
+	if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+
+	const auto ptr = __libc_memalign(alignment, size);
+
+	if (!ptr) return ENOMEM;
+
+	*out = ptr;
+
+	return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+	check("pthread_mutex_lock");
+
+	return resolve(host::rt_check::real_mutex_lock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex)
+{
+	check("pthread_mutex_trylock");
+
+	return resolve(host::rt_check::real_mutex_trylock, "pthread_mutex_trylock")(mutex);
+}
+
+int pthread_mutex_timedlock(pthread_mutex_t* mutex, const timespec* abstime)
+{
+	check("pthread_mutex_timedlock");
+
+	return resolve(host::rt_check::real_mutex_timedlock, "pthread_mutex_timedlock")(mutex, abstime);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock)
+{
+	check("pthread_rwlock_rdlock");
+
+	return resolve(host::rt_check::real_rwlock_rdlock, "pthread_rwlock_rdlock")(rwlock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock)
+{
+	check("pthread_rwlock_wrlock");
+
+	return resolve(host::rt_check::real_rwlock_wrlock, "pthread_rwlock_wrlock")(rwlock);
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t* rwlock)
+{
+	check("pthread_rwlock_tryrdlock");
+
+	return resolve(host::rt_check::real_rwlock_tryrdlock, "pthread_rwlock_tryrdlock")(rwlock);
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t* rwlock)
+{
+	check("pthread_rwlock_trywrlock");
+
+	return resolve(host::rt_check::real_rwlock_trywrlock, "pthread_rwlock_trywrlock")(rwlock);
+}
+
+int pthread_rwlock_timedrdlock(pthread_rwlock_t* rwlock, const timespec* abstime)
+{
+	check("pthread_rwlock_timedrdlock");
+
+	return resolve(host::rt_check::real_rwlock_timedrdlock, "pthread_rwlock_timedrdlock")(rwlock, abstime);
+}
+
+int pthread_rwlock_timedwrlock(pthread_rwlock_t* rwlock, const timespec* abstime)
+{
+	check("pthread_rwlock_timedwrlock");
+
+	return resolve(host::rt_check::real_rwlock_timedwrlock, "pthread_rwlock_timedwrlock")(rwlock, abstime);
+}
+
+int sem_wait(sem_t* sem)
+{
+	check("sem_wait");
+
+	return resolve(host::rt_check::real_sem_wait, "sem_wait")(sem);
+}
+
+int sem_trywait(sem_t* sem)
+{
+	check("sem_trywait");
+
+	return resolve(host::rt_check::real_sem_trywait, "sem_trywait")(sem);
+}
+
+int sem_timedwait(sem_t* sem, const timespec* abstime)
+{
+	check("sem_timedwait");
+
+	return resolve(host::rt_check::real_sem_timedwait, "sem_timedwait")(sem, abstime);
+}
+
+#if BLINK_RT_CHECK_CLOCK_WAITS
+int pthread_mutex_clocklock(pthread_mutex_t* mutex, clockid_t clock, const timespec* abstime)
+{
+	check("pthread_mutex_clocklock");
+
+	return resolve(host::rt_check::real_mutex_clocklock, "pthread_mutex_clocklock")(mutex, clock, abstime);
+}
+
+int pthread_rwlock_clockrdlock(pthread_rwlock_t* rwlock, clockid_t clock, const timespec* abstime)
+{
+	check("pthread_rwlock_clockrdlock");
+
+	return resolve(host::rt_check::real_rwlock_clockrdlock, "pthread_rwlock_clockrdlock")(rwlock, clock, abstime);
+}
+
+int pthread_rwlock_clockwrlock(pthread_rwlock_t* rwlock, clockid_t clock, const timespec* abstime)
+{
+	check("pthread_rwlock_clockwrlock");
+
+	return resolve(host::rt_check::real_rwlock_clockwrlock, "pthread_rwlock_clockwrlock")(rwlock, clock, abstime);
+}
+
+int sem_clockwait(sem_t* sem, clockid_t clock, const timespec* abstime)
+{
+	check("sem_clockwait");
+
+	return resolve(host::rt_check::real_sem_clockwait, "sem_clockwait")(sem, clock, abstime);
+}
+#endif
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+//
+// Realtime-safety checker
+//
+// Configure the host with BLINK_RT_CHECK=ON to build it with hooks for the
+// allocator (malloc, free, valloc and friends), pthread mutexes and
+// rwlocks, including the timed variants, and semaphore waits. The hooks
+// are defined in the executable so they take precedence over libc for
+// every plugin it loads, but they only do anything while a Scope is alive
+// on the calling thread. The host opens a Scope around each call to a
+// unit's process function, so a plugin which allocates, frees, takes a
+// lock or waits on a semaphore on the audio thread aborts immediately with
+// a stack trace pointing at the culprit.
+//
+// Only supported on Linux with glibc.
+//
+
+namespace host {
+namespace rt_check {
+
+#ifdef BLINK_RT_CHECK
+
+// Resolves the real functions. Call once before any Scope is opened
+void init();
+
+class Scope
+{
+public:
+
+	Scope();
+	~Scope();
+
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+};
+
+constexpr bool ENABLED = true;
+
+#else
+
+inline void init() {}
+
+struct Scope { Scope() {} };
+
+constexpr bool ENABLED = false;
+
+#endif
+
+}}
@@ -0,0 +1,232 @@
+//
+// Minimal effect for running the framework through blink_host (see
+// ../CMakeLists.txt). Adds a short echo to the input, scaled by an amp
+// slider and panned by a pan envelope.
+//
+// The echo buffer is freed when the unit is deactivated and allocated
+// again when it is activated, and the gain is only recalculated when the
+// amp slider changes
+//
+
+#define BLINK_EXPORT
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <blink_effect.h>
+#include <blink/effect_plugin.hpp>
+#include <blink/standard_parameters.hpp>
+#include <blink/bind.hpp>
+
+namespace test_effect {
+
+enum ParameterIndex
+{
+	Amp,
+	Pan,
+};
+
+class Plugin final : public blink::EffectPlugin
+{
+public:
+
+	Plugin()
+		: amp(add_parameter(blink::std_params::sliders::parameters::amp()))
+		, pan(add_parameter(blink::std_params::envelopes::pan()))
+	{
+	}
+
+	const std::shared_ptr<blink::SliderParameter<float>> amp;
+	const std::shared_ptr<blink::EnvelopeParameter> pan;
+
+private:
+
+	blink::EffectInstance* make_instance() override;
+};
+
+class Unit : public blink::EffectUnit
+{
+public:
+
+	Unit(blink::EffectInstance* instance)
+		: blink::EffectUnit(instance)
+		, plugin_(static_cast<Plugin*>(instance->get_plugin()))
+		, echo_(ECHO_FRAMES * 2, 0.0f)
+	{
+		// Each output frame only depends on the input frame at the same
+		// index and on the echo buffer
+		set_in_place_safe(true);
+	}
+
+private:
+
+	static constexpr int ECHO_FRAMES = 2048;
+
+	blink_Error process(const blink_EffectBuffer* buffer, const float* in, float* out) override
+	{
+		if (parameter_changes().is_dirty(Amp))
+		{
+			const auto slider = blink::Plugin::get_slider_data(buffer->parameter_data, Amp);
+
+			gain_ = slider ? slider->value : plugin_->amp->spec().slider.default_value;
+		}
+
+		ml::DSPVectorArray<2> frames;
+
+		for (int c = 0; c < 2; c++)
+		{
+			const auto channel_in = in + (c * kFloatsPerDSPVector);
+			const auto channel_out = frames.getBuffer() + (c * kFloatsPerDSPVector);
+			const auto channel_echo = echo_.data() + (c * ECHO_FRAMES);
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				const auto index = (echo_pos_ + i) % ECHO_FRAMES;
+				const auto dry = channel_in[i];
+
+				channel_out[i] = (dry + (channel_echo[index] * 0.25f)) * gain_;
+				channel_echo[index] = dry;
+			}
+		}
+
+		echo_pos_ = (echo_pos_ + kFloatsPerDSPVector) % ECHO_FRAMES;
+
+		const auto pan_data = blink::Plugin::get_envelope_data<Pan>(buffer->parameter_data);
+		const auto panned = stereo_pan(frames, 0.0f, *plugin_->pan, pan_data, block_positions());
+
+		std::copy(panned.getConstBuffer(), panned.getConstBuffer() + (kFloatsPerDSPVector * 2), out);
+
+		return BLINK_OK;
+	}
+
+	void reset() override
+	{
+		std::fill(echo_.begin(), echo_.end(), 0.0f);
+
+		echo_pos_ = 0;
+	}
+
+	void on_activate() override
+	{
+		echo_.resize(ECHO_FRAMES * 2, 0.0f);
+	}
+
+	void on_deactivate() override
+	{
+		std::vector<float>().swap(echo_);
+	}
+
+	const Plugin* plugin_;
+	std::vector<float> echo_;
+	int echo_pos_ = 0;
+	float gain_ = 1.0f;
+};
+
+class Instance : public blink::EffectInstance
+{
+public:
+
+	using blink::EffectInstance::EffectInstance;
+
+private:
+
+	std::shared_ptr<blink::EffectUnit> make_unit() override
+	{
+		return make_arena_unit<Unit>(this);
+	}
+};
+
+inline blink::EffectInstance* Plugin::make_instance()
+{
+	return new (get_arena()) Instance(this);
+}
+
+Plugin* g_plugin = nullptr;
+
+}
+
+using test_effect::g_plugin;
+
+blink_Error blink_init()
+{
+	if (g_plugin) return blink_StdError_AlreadyInitialized;
+
+	g_plugin = new test_effect::Plugin();
+
+	return BLINK_OK;
+}
+
+blink_Error blink_terminate()
+{
+	if (!g_plugin) return blink_StdError_NotInitialized;
+
+	delete g_plugin;
+
+	g_plugin = nullptr;
+
+	return BLINK_OK;
+}
+
+blink_Error blink_stream_init(blink_SR SR)
+{
+	g_plugin->stream_init(SR);
+
+	return BLINK_OK;
+}
+
+const char* blink_get_plugin_name()
+{
+	return "Test Effect";
+}
+
+int blink_get_num_parameters()
+{
+	return g_plugin->get_num_parameters();
+}
+
+blink_Parameter blink_get_parameter(blink_Index index)
+{
+	return blink::bind::parameter(g_plugin->get_parameter(index));
+}
+
+blink_EffectInstance blink_make_effect_instance()
+{
+	return blink::bind::effect_instance(g_plugin->add_instance());
+}
+
+blink_Error blink_destroy_effect_instance(blink_EffectInstance instance)
+{
+	g_plugin->destroy_instance((blink::EffectInstance*)(instance.proc_data));
+
+	return BLINK_OK;
+}
+
+blink_Error blink_effect_process_vectors(void* unit_proc_data, const blink_EffectBuffer* buffer, blink_Index num_vectors, const float* in, float* out)
+{
+	return blink::bind::effect_process_vectors(unit_proc_data, buffer, num_vectors, in, out);
+}
+
+int blink_effect_get_unit_flags(void* unit_proc_data)
+{
+	return blink::bind::effect_unit_flags(unit_proc_data);
+}
+
+enum blink_OutputState blink_get_output_state(void* unit_proc_data)
+{
+	return blink::bind::output_state<blink::EffectUnit>(unit_proc_data);
+}
+
+blink_Error blink_activate_unit(void* unit_proc_data)
+{
+	return blink::bind::activate_unit<blink::EffectUnit>(unit_proc_data);
+}
+
+blink_Error blink_deactivate_unit(void* unit_proc_data)
+{
+	return blink::bind::deactivate_unit<blink::EffectUnit>(unit_proc_data);
+}
+
+blink_Error blink_set_parameter_generations(void* unit_proc_data, const uint64_t* generations)
+{
+	return blink::bind::set_parameter_generations<blink::EffectUnit>(unit_proc_data, generations);
+}
@@ -0,0 +1,196 @@
+//
+// The test synth again (see synth.cpp), but processing its voices together
+// through SynthPlugin::process_voices(), one voice per SIMD lane. Built with
+// BLINK_PROFILE so that the host can check the grouped profile records.
+//
+// The oscillator's phase comes from the song position and rate, so the
+// voices don't need to keep any state of their own
+//
+
+#define BLINK_EXPORT
+
+#include <cmath>
+#include <blink_synth.h>
+#include <blink/standard_parameters.hpp>
+#include <blink/synth_plugin.hpp>
+#include <blink/bind.hpp>
+
+namespace test_grouped_synth {
+
+enum ParameterIndex
+{
+	Amp,
+	Pitch,
+};
+
+class Plugin final : public blink::SynthPlugin
+{
+public:
+
+	Plugin()
+		: amp(add_parameter(blink::std_params::envelopes::amp()))
+		, pitch(add_parameter(blink::std_params::envelopes::pitch()))
+	{
+		enable_voice_processing(true);
+	}
+
+	const std::shared_ptr<blink::EnvelopeParameter> amp;
+	const std::shared_ptr<blink::EnvelopeParameter> pitch;
+
+private:
+
+	blink::SynthInstance* make_instance() override;
+
+	blink_Error process_voices(blink::SynthVoices<>& voices) override
+	{
+		auto phase = voices.positions();
+
+		const auto amp_values = voices.search(*amp, Amp);
+		const auto pitch_values = voices.search(*pitch, Pitch);
+
+		const auto inv_SR = 1.0f / float(voices.buffer(0)->song_rate);
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			for (int lane = 0; lane < blink::SIMD_LANES; lane++)
+			{
+				const auto frequency = 220.0f * std::pow(2.0f, pitch_values.frames[i][lane] / 12.0f);
+				const auto cycles = phase.frames[i][lane] * frequency * inv_SR;
+
+				phase.frames[i][lane] = std::sin((cycles - std::floor(cycles)) * 6.2831853f);
+			}
+		}
+
+		phase *= amp_values;
+
+		voices.write(phase, phase);
+
+		return BLINK_OK;
+	}
+};
+
+class Unit : public blink::SynthUnit
+{
+public:
+
+	using blink::SynthUnit::SynthUnit;
+
+private:
+
+	// Only called if voice processing is disabled
+	blink_Error process(const blink_SynthBuffer*, float*) override
+	{
+		return blink_StdError_NotImplemented;
+	}
+
+	void reset() override {}
+};
+
+class Instance : public blink::SynthInstance
+{
+public:
+
+	using blink::SynthInstance::SynthInstance;
+
+private:
+
+	std::shared_ptr<blink::SynthUnit> make_unit() override
+	{
+		return make_arena_unit<Unit>(this);
+	}
+};
+
+inline blink::SynthInstance* Plugin::make_instance()
+{
+	return new (get_arena()) Instance(this);
+}
+
+Plugin* g_plugin = nullptr;
+
+}
+
+using test_grouped_synth::g_plugin;
+
+blink_Error blink_init()
+{
+	if (g_plugin) return blink_StdError_AlreadyInitialized;
+
+	g_plugin = new test_grouped_synth::Plugin();
+
+	return BLINK_OK;
+}
+
+blink_Error blink_terminate()
+{
+	if (!g_plugin) return blink_StdError_NotInitialized;
+
+	delete g_plugin;
+
+	g_plugin = nullptr;
+
+	return BLINK_OK;
+}
+
+blink_Error blink_stream_init(blink_SR SR)
+{
+	g_plugin->stream_init(SR);
+
+	return BLINK_OK;
+}
+
+const char* blink_get_plugin_name()
+{
+	return "Test Grouped Synth";
+}
+
+int blink_get_num_parameters()
+{
+	return g_plugin->get_num_parameters();
+}
+
+blink_Parameter blink_get_parameter(blink_Index index)
+{
+	return blink::bind::parameter(g_plugin->get_parameter(index));
+}
+
+blink_SynthInstance blink_make_synth_instance()
+{
+	return blink::bind::synth_instance(g_plugin->add_instance());
+}
+
+blink_Error blink_destroy_synth_instance(blink_SynthInstance instance)
+{
+	g_plugin->destroy_instance((blink::SynthInstance*)(instance.proc_data));
+
+	return BLINK_OK;
+}
+
+blink_Error blink_synth_process_batch(blink_SynthJob* jobs, blink_Index count)
+{
+	return g_plugin->process_batch(jobs, count);
+}
+
+enum blink_OutputState blink_get_output_state(void* unit_proc_data)
+{
+	return blink::bind::output_state<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_activate_unit(void* unit_proc_data)
+{
+	return blink::bind::activate_unit<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_deactivate_unit(void* unit_proc_data)
+{
+	return blink::bind::deactivate_unit<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_set_parameter_generations(void* unit_proc_data, const uint64_t* generations)
+{
+	return blink::bind::set_parameter_generations<blink::SynthUnit>(unit_proc_data, generations);
+}
+
+blink_Error blink_get_profile_stats(void* unit_proc_data, blink_ProfileStats* out)
+{
+	return blink::bind::profile_stats<blink::SynthUnit>(unit_proc_data, out);
+}
@@ -0,0 +1,196 @@
+//
+// Minimal sampler for running the framework through blink_host (see
+// ../CMakeLists.txt). Plays the sample back with the classic traverser,
+// following a pitch envelope, scaled by an amp envelope
+//
+
+#define BLINK_EXPORT
+
+#include <blink_sampler.h>
+#include <blink/sample_data.hpp>
+#include <blink/sampler_plugin.hpp>
+#include <blink/standard_parameters.hpp>
+#include <blink/standard_traversers/classic.hpp>
+#include <blink/traverser.hpp>
+#include <blink/bind.hpp>
+
+namespace test_sampler {
+
+enum ParameterIndex
+{
+	Amp,
+	Pitch,
+};
+
+class Plugin final : public blink::SamplerPlugin
+{
+public:
+
+	Plugin()
+		: amp(add_parameter(blink::std_params::envelopes::amp()))
+		, pitch(add_parameter(blink::std_params::envelopes::pitch()))
+	{
+	}
+
+	const std::shared_ptr<blink::EnvelopeParameter> amp;
+	const std::shared_ptr<blink::EnvelopeParameter> pitch;
+
+private:
+
+	blink::SamplerInstance* make_instance() override;
+};
+
+class Unit : public blink::SamplerUnit
+{
+public:
+
+	Unit(blink::SamplerInstance* instance)
+		: blink::SamplerUnit(instance)
+		, plugin_(static_cast<Plugin*>(instance->get_plugin()))
+	{
+	}
+
+private:
+
+	blink_Error process(const blink_SamplerBuffer* buffer, float* out) override
+	{
+		traverser_.generate(block_positions());
+
+		blink::FixedPositionVector positions;
+
+		const auto pitch_data = blink::Plugin::get_envelope_data<Pitch>(buffer->parameter_data);
+
+		classic_.get_positions(0.0f, pitch_data, traverser_, 0, kFloatsPerDSPVector, &positions);
+
+		const blink::SampleData sample_data(buffer->sample_info, buffer->channel_mode);
+
+		const auto frames = sample_data.read_frames_interp<2>(positions, false);
+
+		const auto amp_data = blink::Plugin::get_envelope_data<Amp>(buffer->parameter_data);
+		const auto amp = plugin_->amp->search_vec(amp_data, block_positions());
+
+		for (int c = 0; c < 2; c++)
+		{
+			const auto channel_in = frames.getConstBuffer() + (c * kFloatsPerDSPVector);
+			const auto channel_out = out + (c * kFloatsPerDSPVector);
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				channel_out[i] = channel_in[i] * amp.getConstBuffer()[i];
+			}
+		}
+
+		return BLINK_OK;
+	}
+
+	// The traverser picks up jumps in the song position by itself
+	void reset() override {}
+
+	const Plugin* plugin_;
+	blink::Traverser traverser_;
+	blink::std_traversers::Classic classic_;
+};
+
+class Instance : public blink::SamplerInstance
+{
+public:
+
+	using blink::SamplerInstance::SamplerInstance;
+
+private:
+
+	std::shared_ptr<blink::SamplerUnit> make_unit() override
+	{
+		return make_arena_unit<Unit>(this);
+	}
+};
+
+inline blink::SamplerInstance* Plugin::make_instance()
+{
+	return new (get_arena()) Instance(this);
+}
+
+Plugin* g_plugin = nullptr;
+
+}
+
+using test_sampler::g_plugin;
+
+blink_Error blink_init()
+{
+	if (g_plugin) return blink_StdError_AlreadyInitialized;
+
+	g_plugin = new test_sampler::Plugin();
+
+	return BLINK_OK;
+}
+
+blink_Error blink_terminate()
+{
+	if (!g_plugin) return blink_StdError_NotInitialized;
+
+	delete g_plugin;
+
+	g_plugin = nullptr;
+
+	return BLINK_OK;
+}
+
+blink_Error blink_stream_init(blink_SR SR)
+{
+	g_plugin->stream_init(SR);
+
+	return BLINK_OK;
+}
+
+const char* blink_get_plugin_name()
+{
+	return "Test Sampler";
+}
+
+int blink_get_num_parameters()
+{
+	return g_plugin->get_num_parameters();
+}
+
+blink_Parameter blink_get_parameter(blink_Index index)
+{
+	return blink::bind::parameter(g_plugin->get_parameter(index));
+}
+
+blink_SamplerInstance blink_make_sampler_instance()
+{
+	return blink::bind::sampler_instance(g_plugin->add_instance());
+}
+
+blink_Error blink_destroy_sampler_instance(blink_SamplerInstance instance)
+{
+	g_plugin->destroy_instance((blink::SamplerInstance*)(instance.proc_data));
+
+	return BLINK_OK;
+}
+
+blink_Error blink_sampler_process_vectors(void* unit_proc_data, const blink_SamplerBuffer* buffer, blink_Index num_vectors, float* out)
+{
+	return blink::bind::sampler_process_vectors(unit_proc_data, buffer, num_vectors, out);
+}
+
+enum blink_OutputState blink_get_output_state(void* unit_proc_data)
+{
+	return blink::bind::output_state<blink::SamplerUnit>(unit_proc_data);
+}
+
+blink_Error blink_activate_unit(void* unit_proc_data)
+{
+	return blink::bind::activate_unit<blink::SamplerUnit>(unit_proc_data);
+}
+
+blink_Error blink_deactivate_unit(void* unit_proc_data)
+{
+	return blink::bind::deactivate_unit<blink::SamplerUnit>(unit_proc_data);
+}
+
+blink_Error blink_set_parameter_generations(void* unit_proc_data, const uint64_t* generations)
+{
+	return blink::bind::set_parameter_generations<blink::SamplerUnit>(unit_proc_data, generations);
+}
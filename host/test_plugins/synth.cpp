@@ -0,0 +1,187 @@
+//
+// Minimal synth for running the framework through blink_host (see
+// ../CMakeLists.txt). A sine wave following a pitch envelope, scaled by an
+// amp envelope
+//
+
+#define BLINK_EXPORT
+
+#include <cmath>
+#include <blink_synth.h>
+#include <blink/standard_parameters.hpp>
+#include <blink/synth_plugin.hpp>
+#include <blink/bind.hpp>
+
+namespace test_synth {
+
+enum ParameterIndex
+{
+	Amp,
+	Pitch,
+};
+
+class Plugin final : public blink::SynthPlugin
+{
+public:
+
+	Plugin()
+		: amp(add_parameter(blink::std_params::envelopes::amp()))
+		, pitch(add_parameter(blink::std_params::envelopes::pitch()))
+	{
+	}
+
+	const std::shared_ptr<blink::EnvelopeParameter> amp;
+	const std::shared_ptr<blink::EnvelopeParameter> pitch;
+
+private:
+
+	blink::SynthInstance* make_instance() override;
+};
+
+class Unit : public blink::SynthUnit
+{
+public:
+
+	Unit(blink::SynthInstance* instance)
+		: blink::SynthUnit(instance)
+		, plugin_(static_cast<Plugin*>(instance->get_plugin()))
+	{
+	}
+
+private:
+
+	blink_Error process(const blink_SynthBuffer* buffer, float* out) override
+	{
+		const auto amp_data = blink::Plugin::get_envelope_data<Amp>(buffer->parameter_data);
+		const auto pitch_data = blink::Plugin::get_envelope_data<Pitch>(buffer->parameter_data);
+
+		const auto amp = plugin_->amp->search_vec(amp_data, block_positions());
+		const auto pitch = plugin_->pitch->search_vec(pitch_data, block_positions());
+
+		const auto inv_SR = 1.0f / float(SR());
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			const auto frequency = 220.0f * std::pow(2.0f, pitch.getConstBuffer()[i] / 12.0f);
+
+			phase_ += frequency * inv_SR;
+			phase_ -= std::floor(phase_);
+
+			out[i] = out[kFloatsPerDSPVector + i] = std::sin(phase_ * 6.2831853f) * amp.getConstBuffer()[i];
+		}
+
+		return BLINK_OK;
+	}
+
+	void reset() override
+	{
+		phase_ = 0.0f;
+	}
+
+	const Plugin* plugin_;
+	float phase_ = 0.0f;
+};
+
+class Instance : public blink::SynthInstance
+{
+public:
+
+	using blink::SynthInstance::SynthInstance;
+
+private:
+
+	std::shared_ptr<blink::SynthUnit> make_unit() override
+	{
+		return make_arena_unit<Unit>(this);
+	}
+};
+
+inline blink::SynthInstance* Plugin::make_instance()
+{
+	return new (get_arena()) Instance(this);
+}
+
+Plugin* g_plugin = nullptr;
+
+}
+
+using test_synth::g_plugin;
+
+blink_Error blink_init()
+{
+	if (g_plugin) return blink_StdError_AlreadyInitialized;
+
+	g_plugin = new test_synth::Plugin();
+
+	return BLINK_OK;
+}
+
+blink_Error blink_terminate()
+{
+	if (!g_plugin) return blink_StdError_NotInitialized;
+
+	delete g_plugin;
+
+	g_plugin = nullptr;
+
+	return BLINK_OK;
+}
+
+blink_Error blink_stream_init(blink_SR SR)
+{
+	g_plugin->stream_init(SR);
+
+	return BLINK_OK;
+}
+
+const char* blink_get_plugin_name()
+{
+	return "Test Synth";
+}
+
+int blink_get_num_parameters()
+{
+	return g_plugin->get_num_parameters();
+}
+
+blink_Parameter blink_get_parameter(blink_Index index)
+{
+	return blink::bind::parameter(g_plugin->get_parameter(index));
+}
+
+blink_SynthInstance blink_make_synth_instance()
+{
+	return blink::bind::synth_instance(g_plugin->add_instance());
+}
+
+blink_Error blink_destroy_synth_instance(blink_SynthInstance instance)
+{
+	g_plugin->destroy_instance((blink::SynthInstance*)(instance.proc_data));
+
+	return BLINK_OK;
+}
+
+blink_Error blink_synth_process_vectors(void* unit_proc_data, const blink_SynthBuffer* buffer, blink_Index num_vectors, float* out)
+{
+	return blink::bind::synth_process_vectors(unit_proc_data, buffer, num_vectors, out);
+}
+
+enum blink_OutputState blink_get_output_state(void* unit_proc_data)
+{
+	return blink::bind::output_state<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_activate_unit(void* unit_proc_data)
+{
+	return blink::bind::activate_unit<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_deactivate_unit(void* unit_proc_data)
+{
+	return blink::bind::deactivate_unit<blink::SynthUnit>(unit_proc_data);
+}
+
+blink_Error blink_set_parameter_generations(void* unit_proc_data, const uint64_t* generations)
+{
+	return blink::bind::set_parameter_generations<blink::SynthUnit>(unit_proc_data, generations);
+}
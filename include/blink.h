@@ -51,6 +51,14 @@ enum blink_ChannelMode
 	blink_ChannelMode_Stereo = 2,
 };
 
+// Describes the output of the most recent call to a unit's process function
+enum blink_OutputState
+{
+	blink_OutputState_Active = 0,   // Anything else
+	blink_OutputState_Silent = 1,   // Every frame is silent (the host can skip mixing it)
+	blink_OutputState_Constant = 2, // Every frame of each channel has the same value
+};
+
 enum blink_StdIcon
 {
 	blink_StdIcon_None = 0,
@@ -75,6 +83,9 @@ enum blink_StdError
 	blink_StdError_AlreadyInitialized = -1,
 	blink_StdError_NotInitialized = -2,
 	blink_StdError_NotImplemented = -3,
+	blink_StdError_FileError = -4,
+	blink_StdError_InvalidArgument = -5,
+	blink_StdError_UnitInactive = -6,
 };
 
 typedef struct
@@ -442,6 +453,25 @@ typedef struct
 	const char* name;
 } blink_Group;
 
+// Per-unit profiling statistics, for plugins built with BLINK_PROFILE (see
+// blink_get_profile_stats())
+//
+// Times are in CPU timestamp counter ticks if [timestamp_counter] is true,
+// otherwise nanoseconds. Everything covers the process calls made since the
+// previous call to blink_get_profile_stats() for the same unit
+typedef struct
+{
+	uint64_t num_calls;
+	uint64_t num_dropped;       // Calls which weren't recorded because the host didn't poll often enough
+	uint64_t process_time;      // Total time spent in process calls
+	uint64_t process_time_max;  // Longest single process call
+	uint64_t envelope_time;     // Time spent evaluating envelopes and chords
+	uint64_t sample_time;       // Time spent fetching sample data from the host
+	uint64_t num_resets;        // Traverser reset points
+	uint64_t num_binary_searches;
+	blink_Bool timestamp_counter;
+} blink_ProfileStats;
+
 #ifdef BLINK_EXPORT
 
 #ifdef _WIN32
@@ -468,6 +498,70 @@ extern "C"
 	// Returned buffer remains valid until the next call to get_error_string or
 	// until the generator is destroyed
 	EXPORTED const char* blink_get_error_string(blink_Error error);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Fills in [out] with the profiling statistics of the unit whose
+	// proc_data is [unit_proc_data], and starts the next period. Can be
+	// called from any one non-audio thread at a time while the unit is
+	// processing.
+	//
+	// Returns an error if the plugin wasn't built with profiling enabled
+	EXPORTED blink_Error blink_get_profile_stats(void* unit_proc_data, blink_ProfileStats* out);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Returns the state of the output of the most recent process call of
+	// the unit whose proc_data is [unit_proc_data]. Call it from the audio
+	// thread after processing. After a multi-vector process call the state
+	// is blink_OutputState_Silent only if every vector was silent,
+	// otherwise it is blink_OutputState_Active.
+	//
+	// The output buffer is always written in full, so hosts are free to
+	// ignore this and mix silent units as usual
+	EXPORTED enum blink_OutputState blink_get_output_state(void* unit_proc_data);
+
+	// Optional. Hosts should check that the plugin exports these.
+	//
+	// Units start off active. The host may deactivate units which it doesn't
+	// expect to process for a while (e.g. crossfade units which aren't
+	// currently fading) so that they can release memory, and must activate
+	// them again before processing them. Processing an inactive unit fails
+	// with blink_StdError_UnitInactive.
+	//
+	// These may allocate or free memory, so call them from a non-audio
+	// thread, and never while the unit is processing
+	EXPORTED blink_Error blink_activate_unit(void* unit_proc_data);
+	EXPORTED blink_Error blink_deactivate_unit(void* unit_proc_data);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Gives the unit whose proc_data is [unit_proc_data] an array of
+	// generation counters, one per parameter. The host increments a
+	// parameter's counter whenever that parameter's data changes, which
+	// lets the plugin skip recalculating anything derived from parameters
+	// which haven't changed. Units of the same instance can share one array.
+	//
+	// The array must stay valid until the unit is destroyed or this is
+	// called again. Until this is called, or after it is called with null,
+	// every parameter is treated as changed on every process call.
+	//
+	// Call from a non-audio thread, never while the unit is processing
+	EXPORTED blink_Error blink_set_parameter_generations(void* unit_proc_data, const uint64_t* generations);
+
+	// Optional. Hosts should check that the plugin exports these.
+	//
+	// Records a timeline of process calls, resets and preprocessing progress
+	// to a Chrome trace JSON file (open it in chrome://tracing or Perfetto).
+	// Recording happens on the audio thread without locking or allocating.
+	// blink_trace_flush() writes out what has been recorded so far and
+	// should be called regularly from a non-audio thread, otherwise events
+	// are dropped once the buffer fills up.
+	//
+	// Return an error if the plugin wasn't built with tracing enabled
+	EXPORTED blink_Error blink_trace_begin(const char* path);
+	EXPORTED blink_Error blink_trace_flush();
+	EXPORTED blink_Error blink_trace_end();
 }
 
 #endif
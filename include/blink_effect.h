@@ -45,6 +45,23 @@ typedef struct
 	blink_Effect_Process process;
 } blink_EffectUnit;
 
+// One unit's worth of work for blink_effect_process_batch()
+typedef struct
+{
+	void* proc_data; // blink_EffectUnit.proc_data
+	const blink_EffectBuffer* buffer;
+	const float* in;
+	float* out;
+	blink_Error result; // Set by the plugin
+} blink_EffectJob;
+
+// See blink_effect_get_unit_flags()
+enum blink_EffectUnitFlags
+{
+	blink_EffectUnitFlags_None    = 0,
+	blink_EffectUnitFlags_InPlace = 1 << 0, // process() with in == out costs nothing extra
+};
+
 typedef blink_EffectInstanceInfo(*blink_EffectInstance_GetInfo)(void* proc_data);
 typedef blink_EffectUnit(*blink_EffectInstance_AddUnit)(void* proc_data);
 
@@ -69,5 +86,40 @@ extern "C"
 {
 	EXPORTED blink_EffectInstance blink_make_effect_instance();
 	EXPORTED blink_Error blink_destroy_effect_instance(blink_EffectInstance instance);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes a single vector for each job, exactly as if each unit's
+	// process() had been called in turn, but with one call into the plugin.
+	// Jobs for units of the same instance should be next to each other.
+	//
+	// Returns the first error, and each job's own result is stored in the
+	// job
+	EXPORTED blink_Error blink_effect_process_batch(blink_EffectJob* jobs, blink_Index count);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes [num_vectors] consecutive vectors for the unit whose
+	// proc_data is [unit_proc_data]. This is equivalent to calling the
+	// unit's process() [num_vectors] times, but cheaper.
+	//
+	// buffer->positions is an array of size BLINK_VECTOR_SIZE * num_vectors.
+	// buffer->buffer_id is the ID of the first vector, and the following
+	// vectors have consecutive IDs.
+	//
+	// in and out are arrays of size BLINK_VECTOR_SIZE * 2 * num_vectors. Each
+	// vector has the same layout as in process()
+	//
+	// Returns blink_StdError_InvalidArgument if [num_vectors] is less than 1
+	EXPORTED blink_Error blink_effect_process_vectors(void* unit_proc_data, const blink_EffectBuffer* buffer, blink_Index num_vectors, const float* in, float* out);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Returns the blink_EffectUnitFlags of the unit whose proc_data is
+	// [unit_proc_data]. Any unit may be called with in == out, but units
+	// without blink_EffectUnitFlags_InPlace may have to copy their input
+	// first, so hosts which have a spare buffer should give them separate
+	// in and out buffers
+	EXPORTED int blink_effect_get_unit_flags(void* unit_proc_data);
 }
 #endif
@@ -110,6 +110,15 @@ typedef struct
 	blink_Sampler_Process process;
 } blink_SamplerUnit;
 
+// One unit's worth of work for blink_sampler_process_batch()
+typedef struct
+{
+	void* proc_data; // blink_SamplerUnit.proc_data
+	const blink_SamplerBuffer* buffer;
+	float* out;
+	blink_Error result; // Set by the plugin
+} blink_SamplerJob;
+
 typedef blink_SamplerUnit(*blink_SamplerInstance_AddUnit)(void* proc_data);
 
 typedef struct
@@ -176,5 +185,32 @@ extern "C"
 	// The host takes care of actually rendering the waveform but relies on
 	// the plugin to calculate the waveform position at each pixel.
 	EXPORTED blink_Error blink_sampler_draw(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes a single vector for each job, exactly as if each unit's
+	// process() had been called in turn, but with one call into the plugin.
+	// Jobs for units of the same instance should be next to each other.
+	//
+	// Returns the first error, and each job's own result is stored in the
+	// job
+	EXPORTED blink_Error blink_sampler_process_batch(blink_SamplerJob* jobs, blink_Index count);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes [num_vectors] consecutive vectors for the unit whose
+	// proc_data is [unit_proc_data]. This is equivalent to calling the
+	// unit's process() [num_vectors] times, but cheaper.
+	//
+	// buffer->positions is an array of size BLINK_VECTOR_SIZE * num_vectors.
+	// buffer->buffer_id is the ID of the first vector, and the following
+	// vectors have consecutive IDs.
+	//
+	// output pointer is aligned on a 16-byte boundary
+	// output pointer is an array of size BLINK_VECTOR_SIZE * 2 * num_vectors.
+	// Each vector's output has the same layout as the output of process()
+	//
+	// Returns blink_StdError_InvalidArgument if [num_vectors] is less than 1
+	EXPORTED blink_Error blink_sampler_process_vectors(void* unit_proc_data, const blink_SamplerBuffer* buffer, blink_Index num_vectors, float* out);
 }
 #endif
@@ -24,6 +24,15 @@ typedef struct
 	blink_Synth_Process process;
 } blink_SynthUnit;
 
+// One unit's worth of work for blink_synth_process_batch()
+typedef struct
+{
+	void* proc_data; // blink_SynthUnit.proc_data
+	const blink_SynthBuffer* buffer;
+	float* out;
+	blink_Error result; // Set by the plugin
+} blink_SynthJob;
+
 typedef blink_SynthUnit(*blink_SynthInstance_AddUnit)(void* proc_data);
 
 typedef struct
@@ -45,5 +54,31 @@ extern "C"
 {
 	EXPORTED blink_SynthInstance blink_make_synth_instance();
 	EXPORTED blink_Error blink_destroy_synth_instance(blink_SynthInstance instance);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes a single vector for each job, exactly as if each unit's
+	// process() had been called in turn, but with one call into the plugin.
+	// Jobs for units of the same instance should be next to each other.
+	//
+	// Returns the first error, and each job's own result is stored in the
+	// job
+	EXPORTED blink_Error blink_synth_process_batch(blink_SynthJob* jobs, blink_Index count);
+
+	// Optional. Hosts should check that the plugin exports it.
+	//
+	// Processes [num_vectors] consecutive vectors for the unit whose
+	// proc_data is [unit_proc_data]. This is equivalent to calling the
+	// unit's process() [num_vectors] times, but cheaper.
+	//
+	// buffer->positions is an array of size BLINK_VECTOR_SIZE * num_vectors.
+	// buffer->buffer_id is the ID of the first vector, and the following
+	// vectors have consecutive IDs.
+	//
+	// out is an array of size BLINK_VECTOR_SIZE * 2 * num_vectors. Each
+	// vector's output has the same layout as the output of process()
+	//
+	// Returns blink_StdError_InvalidArgument if [num_vectors] is less than 1
+	EXPORTED blink_Error blink_synth_process_vectors(void* unit_proc_data, const blink_SynthBuffer* buffer, blink_Index num_vectors, float* out);
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace blink {
+
+//
+// Cache line aligned pool allocator which instances and units are allocated
+// from. Memory is handed out from large chunks, so objects which are
+// created one after the other (e.g. an instance and its units) end up next
+// to each other in memory. Freed memory goes onto a free list for its size
+// and is reused.
+//
+// Each Plugin owns one (see Plugin::get_arena()), so plugins never share
+// an arena even if their modules' symbols are merged. Allocation takes a
+// lock and must not happen in the audio thread
+//
+class Arena
+{
+public:
+
+	static constexpr std::size_t ALIGNMENT = 64;
+	static constexpr std::size_t CHUNK_SIZE = std::size_t(1) << 16;
+
+	// Anything bigger than this comes straight from the heap
+	static constexpr std::size_t MAX_SIZE = CHUNK_SIZE / 4;
+
+	Arena() = default;
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	~Arena();
+
+	void* allocate(std::size_t size);
+	void deallocate(void* ptr, std::size_t size);
+
+	//
+	// For objects which are freed by a plain operator delete, which doesn't
+	// know which arena the memory came from. The arena is kept in a header
+	// in front of the object. If [arena] is null the memory comes from the
+	// heap instead
+	//
+	static void* allocate_tagged(Arena* arena, std::size_t size);
+	static void deallocate_tagged(void* ptr, std::size_t size);
+
+	// Makes sure at least [size] bytes can be allocated without another
+	// chunk being needed
+	void reserve(std::size_t size);
+
+private:
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	static std::size_t get_size_class(std::size_t size) { return (size + ALIGNMENT - 1) / ALIGNMENT; }
+
+	void add_chunk(std::size_t size);
+
+	std::mutex mutex_;
+	std::vector<void*> chunks_;
+	char* chunk_pos_ = nullptr;
+	char* chunk_end_ = nullptr;
+	FreeBlock* free_lists_[(MAX_SIZE / ALIGNMENT) + 1] = {};
+};
+
+inline Arena::~Arena()
+{
+	for (const auto chunk : chunks_)
+	{
+		::operator delete(chunk, std::align_val_t(ALIGNMENT));
+	}
+}
+
+inline void Arena::add_chunk(std::size_t size)
+{
+	const auto chunk = ::operator new(size, std::align_val_t(ALIGNMENT));
+
+	chunks_.push_back(chunk);
+
+	chunk_pos_ = static_cast<char*>(chunk);
+	chunk_end_ = chunk_pos_ + size;
+}
+
+inline void Arena::reserve(std::size_t size)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (std::size_t(chunk_end_ - chunk_pos_) >= size) return;
+
+	add_chunk(std::max(CHUNK_SIZE, get_size_class(size) * ALIGNMENT));
+}
+
+inline void* Arena::allocate(std::size_t size)
+{
+	if (size > MAX_SIZE)
+	{
+		return ::operator new(size, std::align_val_t(ALIGNMENT));
+	}
+
+	const auto size_class = get_size_class(size);
+	const auto block_size = size_class * ALIGNMENT;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (const auto block = free_lists_[size_class])
+	{
+		free_lists_[size_class] = block->next;
+
+		return block;
+	}
+
+	if (std::size_t(chunk_end_ - chunk_pos_) < block_size)
+	{
+		add_chunk(CHUNK_SIZE);
+	}
+
+	const auto out = chunk_pos_;
+
+	chunk_pos_ += block_size;
+
+	return out;
+}
+
+inline void Arena::deallocate(void* ptr, std::size_t size)
+{
+	if (!ptr) return;
+
+	if (size > MAX_SIZE)
+	{
+		::operator delete(ptr, std::align_val_t(ALIGNMENT));
+		return;
+	}
+
+	const auto size_class = get_size_class(size);
+	const auto block = static_cast<FreeBlock*>(ptr);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	block->next = free_lists_[size_class];
+	free_lists_[size_class] = block;
+}
+
+inline void* Arena::allocate_tagged(Arena* arena, std::size_t size)
+{
+	// The header is a whole ALIGNMENT so that the object stays aligned
+	const auto total = size + ALIGNMENT;
+	const auto block = static_cast<char*>(arena ? arena->allocate(total) : ::operator new(total, std::align_val_t(ALIGNMENT)));
+
+	*reinterpret_cast<Arena**>(block) = arena;
+
+	return block + ALIGNMENT;
+}
+
+inline void Arena::deallocate_tagged(void* ptr, std::size_t size)
+{
+	if (!ptr) return;
+
+	const auto block = static_cast<char*>(ptr) - ALIGNMENT;
+	const auto arena = *reinterpret_cast<Arena**>(block);
+
+	if (arena)
+	{
+		arena->deallocate(block, size + ALIGNMENT);
+	}
+	else
+	{
+		::operator delete(block, std::align_val_t(ALIGNMENT));
+	}
+}
+
+//
+// Standard allocator interface to an arena
+//
+template <class T>
+struct ArenaAllocator
+{
+	using value_type = T;
+
+	ArenaAllocator(Arena* arena) : arena(arena) {}
+
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U>& rhs) : arena(rhs.arena) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T))); }
+	void deallocate(T* ptr, std::size_t n) { arena->deallocate(ptr, n * sizeof(T)); }
+
+	template <class U> bool operator==(const ArenaAllocator<U>& rhs) const { return arena == rhs.arena; }
+	template <class U> bool operator!=(const ArenaAllocator<U>& rhs) const { return arena != rhs.arena; }
+
+	Arena* arena;
+};
+
+//
+// Puts both the object and its control block in [arena]. See
+// Instance::make_arena_unit()
+//
+template <class T, class... Args>
+inline std::shared_ptr<T> make_arena_shared(Arena& arena, Args&&... args)
+{
+	return std::allocate_shared<T>(ArenaAllocator<T>(&arena), std::forward<Args>(args)...);
+}
+
+}
@@ -0,0 +1,539 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "perf_counters.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace blink {
+namespace bench {
+
+//
+// Stops the compiler from throwing away a result which is never read
+//
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(_MSC_VER)
+	static const void* volatile sink;
+
+	sink = &value;
+
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+// Named values reported by a case alongside its timing
+using Metrics = std::vector<std::pair<std::string, double>>;
+
+// Output of a golden case
+using Values = std::vector<double>;
+
+struct Result
+{
+	std::string name;
+	std::int64_t iterations = 0;
+	std::int64_t items_per_iteration = 1;
+	double ns_per_iteration = 0.0;
+	Metrics metrics;
+	bool failed = false;
+
+	double ns_per_item() const { return ns_per_iteration / double(items_per_iteration); }
+};
+
+//
+// Runs each benchmark case repeatedly, doubling the iteration count until
+// one batch takes at least --min-time seconds, and reports the time of the
+// last batch.
+//
+// Cases are registered with a name, the number of items (samples, frames,
+// positions..) processed by one iteration, and a function which performs
+// one iteration. Any setup should happen before add() is called, or lazily
+// on the first call, so that it isn't included in the timings.
+//
+// Cases added with add_check() are run exactly once and report whatever
+// metrics they return (errors, drift..) along with the time that one run
+// took.
+//
+// Cases added with add_golden() render some deterministic output which is
+// compared against a digest in the --golden directory (the sum of the
+// values and a handful of samples, see GoldenDigest), then timed like any
+// other case. A value matches if it is within [tolerance] of the golden
+// value, relative to the golden value's magnitude when that is above 1.
+// Any mismatch (or missing golden file) makes run() return non-zero.
+// --write-golden writes the files instead, from a build which is known to
+// be good.
+//
+// Cases added with add_test() are run exactly once and fail, making run()
+// return non-zero, if they return a description of what went wrong. They
+// are for behaviour which has a known right answer rather than a golden
+// one.
+//
+// With --perf, timed cases also report hardware counters (IPC, branch and
+// cache miss rates, see PerfCounters) for the batch which was timed.
+//
+// Options:
+//
+//   --filter S          Only run cases whose names contain S
+//   --min-time N        Minimum seconds per case (default 0.1)
+//   --json PATH         Also write the results to PATH
+//   --golden DIR        Compare golden cases against the files in DIR
+//   --write-golden DIR  Write the golden files to DIR
+//   --perf              Report hardware performance counters (Linux only)
+//   --list              List the case names and exit
+//
+class Runner
+{
+public:
+
+	using Fn = std::function<void()>;
+	using CheckFn = std::function<Metrics()>;
+	using RenderFn = std::function<Values()>;
+	using TestFn = std::function<std::string()>;
+
+	Runner(int argc, char** argv);
+
+	void add(std::string name, std::int64_t items_per_iteration, Fn fn);
+	void add_check(std::string name, std::int64_t items, CheckFn fn);
+	void add_golden(std::string name, std::int64_t items_per_iteration, RenderFn fn, double tolerance);
+	void add_test(std::string name, TestFn fn);
+
+	int run();
+
+private:
+
+	struct Case
+	{
+		std::string name;
+		std::int64_t items_per_iteration;
+		Fn fn;
+		CheckFn check;
+		RenderFn render;
+		double tolerance = 0.0;
+		TestFn test;
+	};
+
+	Result measure(const Case& c) const;
+	bool compare_golden(const Case& c, const Values& values, Result* out) const;
+	bool write_golden(const Case& c, const Values& values) const;
+	std::string golden_path(const std::string& dir, const std::string& name) const;
+	bool write_json(const std::vector<Result>& results) const;
+
+	std::vector<Case> cases_;
+	std::string filter_;
+	std::string json_path_;
+	std::string golden_dir_;
+	std::string write_golden_dir_;
+	std::unique_ptr<PerfCounters> counters_;
+	double min_time_ = 0.1;
+	bool list_ = false;
+};
+
+inline Runner::Runner(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (arg == "--filter") filter_ = next();
+		else if (arg == "--min-time") min_time_ = std::atof(next());
+		else if (arg == "--json") json_path_ = next();
+		else if (arg == "--golden") golden_dir_ = next();
+		else if (arg == "--write-golden") write_golden_dir_ = next();
+		else if (arg == "--perf") counters_ = std::make_unique<PerfCounters>();
+		else if (arg == "--list") list_ = true;
+	}
+
+	if (counters_ && !counters_->open())
+	{
+		std::fprintf(stderr, "Hardware performance counters aren't available, carrying on without them\n");
+
+		counters_.reset();
+	}
+}
+
+inline void Runner::add(std::string name, std::int64_t items_per_iteration, Fn fn)
+{
+	if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+	cases_.push_back({ std::move(name), std::max(items_per_iteration, std::int64_t(1)), std::move(fn), nullptr, nullptr });
+}
+
+inline void Runner::add_check(std::string name, std::int64_t items, CheckFn fn)
+{
+	if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+	cases_.push_back({ std::move(name), std::max(items, std::int64_t(1)), nullptr, std::move(fn), nullptr });
+}
+
+inline void Runner::add_golden(std::string name, std::int64_t items_per_iteration, RenderFn fn, double tolerance)
+{
+	if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+	auto render = std::move(fn);
+
+	// Timed like a normal case once the output has been checked
+	auto timed = [render]() { do_not_optimize(render()); };
+
+	cases_.push_back({ std::move(name), std::max(items_per_iteration, std::int64_t(1)), std::move(timed), nullptr, std::move(render), tolerance });
+}
+
+inline void Runner::add_test(std::string name, TestFn fn)
+{
+	if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+	cases_.push_back({ std::move(name), 1, nullptr, nullptr, nullptr, 0.0, std::move(fn) });
+}
+
+inline Result Runner::measure(const Case& c) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	Result out;
+
+	out.name = c.name;
+	out.items_per_iteration = c.items_per_iteration;
+
+	if (c.check)
+	{
+		const auto beg = Clock::now();
+
+		out.metrics = c.check();
+		out.iterations = 1;
+		out.ns_per_iteration = std::chrono::duration<double, std::nano>(Clock::now() - beg).count();
+
+		return out;
+	}
+
+	if (c.test)
+	{
+		const auto beg = Clock::now();
+		const auto error = c.test();
+
+		out.iterations = 1;
+		out.ns_per_iteration = std::chrono::duration<double, std::nano>(Clock::now() - beg).count();
+
+		if (!error.empty())
+		{
+			std::fprintf(stderr, "%s: %s\n", c.name.c_str(), error.c_str());
+
+			out.failed = true;
+		}
+
+		return out;
+	}
+
+	if (c.render)
+	{
+		const auto values = c.render();
+
+		out.metrics.push_back({ "values", double(values.size()) });
+
+		if (!write_golden_dir_.empty())
+		{
+			out.failed = !write_golden(c, values);
+		}
+		else if (!golden_dir_.empty())
+		{
+			out.failed = !compare_golden(c, values, &out);
+		}
+	}
+
+	// Warm up
+	c.fn();
+
+	for (std::int64_t iterations = 1;; iterations *= 2)
+	{
+		if (counters_) counters_->start();
+
+		const auto beg = Clock::now();
+
+		for (std::int64_t i = 0; i < iterations; i++) c.fn();
+
+		const auto seconds = std::chrono::duration<double>(Clock::now() - beg).count();
+
+		if (counters_) counters_->stop();
+
+		if (seconds >= min_time_ || iterations >= (std::int64_t(1) << 40))
+		{
+			out.iterations = iterations;
+			out.ns_per_iteration = (seconds * 1.0e9) / double(iterations);
+
+			if (counters_)
+			{
+				for (const auto& metric : counters_->metrics(double(iterations) * double(c.items_per_iteration)))
+				{
+					out.metrics.push_back(metric);
+				}
+			}
+
+			return out;
+		}
+	}
+}
+
+inline int Runner::run()
+{
+	if (list_)
+	{
+		for (const auto& c : cases_) std::printf("%s\n", c.name.c_str());
+
+		return 0;
+	}
+
+	std::vector<Result> results;
+
+	int num_failed = 0;
+
+	std::size_t name_width = 0;
+
+	for (const auto& c : cases_) name_width = std::max(name_width, c.name.size());
+
+	std::printf("%-*s %14s %12s %12s\n", int(name_width), "case", "iterations", "ns/iter", "ns/item");
+
+	for (const auto& c : cases_)
+	{
+		const auto result = measure(c);
+
+		std::printf("%-*s %14lld %12.1f %12.3f\n",
+			int(name_width), result.name.c_str(),
+			(long long)(result.iterations),
+			result.ns_per_iteration,
+			result.ns_per_item());
+
+		for (const auto& metric : result.metrics)
+		{
+			std::printf("    %s = %g\n", metric.first.c_str(), metric.second);
+		}
+
+		if (result.failed)
+		{
+			std::printf("    FAILED\n");
+
+			num_failed++;
+		}
+
+		std::fflush(stdout);
+
+		results.push_back(result);
+	}
+
+	if (!json_path_.empty() && !write_json(results)) return 1;
+
+	if (num_failed > 0)
+	{
+		std::printf("%d case(s) failed\n", num_failed);
+		return 1;
+	}
+
+	return 0;
+}
+
+inline std::string Runner::golden_path(const std::string& dir, const std::string& name) const
+{
+	auto file = name;
+
+	std::replace(file.begin(), file.end(), '/', '.');
+
+	return dir + "/" + file + ".txt";
+}
+
+//
+// Golden files are a digest of the output rather than the output itself so
+// that they stay small. They are plain text: the number of values, their
+// sum, the sum of their magnitudes (at least one each, which scales the
+// tolerance of the sum), then GOLDEN_SAMPLES evenly spaced values, one per
+// line, each printed with enough digits to round trip
+//
+constexpr std::size_t GOLDEN_SAMPLES = 16;
+
+struct GoldenDigest
+{
+	std::size_t count = 0;
+	double sum = 0.0;
+	double magnitude = 0.0;
+	std::vector<double> samples;
+
+	explicit GoldenDigest(const Values& values)
+		: count(values.size())
+	{
+		for (const auto value : values)
+		{
+			sum += value;
+			magnitude += std::max(1.0, std::abs(value));
+		}
+
+		for (std::size_t i = 0; i < std::min(count, GOLDEN_SAMPLES); i++)
+		{
+			samples.push_back(values[sample_index(i)]);
+		}
+	}
+
+	GoldenDigest() = default;
+
+	std::size_t sample_index(std::size_t i) const
+	{
+		return count <= GOLDEN_SAMPLES ? i : (i * (count - 1)) / (GOLDEN_SAMPLES - 1);
+	}
+};
+
+inline bool Runner::write_golden(const Case& c, const Values& values) const
+{
+	const auto path = golden_path(write_golden_dir_, c.name);
+	const auto file = std::fopen(path.c_str(), "w");
+
+	if (!file)
+	{
+		std::fprintf(stderr, "Failed to open %s for writing\n", path.c_str());
+		return false;
+	}
+
+	const GoldenDigest digest(values);
+
+	std::fprintf(file, "%zu\n%.17g\n%.17g\n", digest.count, digest.sum, digest.magnitude);
+
+	for (const auto sample : digest.samples) std::fprintf(file, "%.17g\n", sample);
+
+	std::fclose(file);
+
+	return true;
+}
+
+inline bool Runner::compare_golden(const Case& c, const Values& values, Result* out) const
+{
+	const auto path = golden_path(golden_dir_, c.name);
+	const auto file = std::fopen(path.c_str(), "r");
+
+	if (!file)
+	{
+		std::fprintf(stderr, "Missing golden file %s\n", path.c_str());
+		return false;
+	}
+
+	const GoldenDigest actual(values);
+
+	GoldenDigest expected;
+
+	if (std::fscanf(file, "%zu %lf %lf", &expected.count, &expected.sum, &expected.magnitude) != 3 || expected.count != actual.count)
+	{
+		std::fprintf(stderr, "%s: expected %zu values, golden file has %zu\n", c.name.c_str(), actual.count, expected.count);
+		std::fclose(file);
+		return false;
+	}
+
+	for (std::size_t i = 0; i < actual.samples.size(); i++)
+	{
+		double sample = 0.0;
+
+		if (std::fscanf(file, "%lf", &sample) != 1)
+		{
+			std::fprintf(stderr, "%s: golden file is truncated\n", c.name.c_str());
+			std::fclose(file);
+			return false;
+		}
+
+		expected.samples.push_back(sample);
+	}
+
+	std::fclose(file);
+
+	const auto same = [](double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+
+	double max_abs_error = 0.0;
+	std::int64_t mismatches = 0;
+	std::int64_t first_mismatch = -1;
+
+	for (std::size_t i = 0; i < actual.samples.size(); i++)
+	{
+		const auto error = std::abs(actual.samples[i] - expected.samples[i]);
+
+		if (same(actual.samples[i], expected.samples[i])) continue;
+
+		max_abs_error = std::max(max_abs_error, error);
+
+		if (!(error <= c.tolerance * std::max(1.0, std::abs(expected.samples[i]))))
+		{
+			if (mismatches++ == 0) first_mismatch = std::int64_t(actual.sample_index(i));
+		}
+	}
+
+	const auto sum_error = std::abs(actual.sum - expected.sum);
+	const auto sum_matches = same(actual.sum, expected.sum) || sum_error <= c.tolerance * expected.magnitude;
+
+	out->metrics.push_back({ "max_abs_error", max_abs_error });
+	out->metrics.push_back({ "sum_error", sum_error });
+	out->metrics.push_back({ "mismatches", double(mismatches) });
+
+	if (mismatches > 0)
+	{
+		out->metrics.push_back({ "first_mismatch", double(first_mismatch) });
+	}
+
+	return mismatches == 0 && sum_matches;
+}
+
+inline bool Runner::write_json(const std::vector<Result>& results) const
+{
+	const auto file = std::fopen(json_path_.c_str(), "w");
+
+	if (!file)
+	{
+		std::fprintf(stderr, "Failed to open %s for writing\n", json_path_.c_str());
+		return false;
+	}
+
+	std::fprintf(file, "{\n\t\"benchmarks\": [\n");
+
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		const auto& result = results[i];
+
+		std::fprintf(file, "\t\t{ \"name\": \"%s\", \"iterations\": %lld, \"items_per_iteration\": %lld, \"ns_per_iteration\": %.3f, \"ns_per_item\": %.4f",
+			result.name.c_str(),
+			(long long)(result.iterations),
+			(long long)(result.items_per_iteration),
+			result.ns_per_iteration,
+			result.ns_per_item());
+
+		if (!result.metrics.empty())
+		{
+			std::fprintf(file, ", \"metrics\": {");
+
+			for (std::size_t m = 0; m < result.metrics.size(); m++)
+			{
+				std::fprintf(file, "%s \"%s\": %.17g", m > 0 ? "," : "", result.metrics[m].first.c_str(), result.metrics[m].second);
+			}
+
+			std::fprintf(file, " }");
+		}
+
+		if (result.failed)
+		{
+			std::fprintf(file, ", \"failed\": true");
+		}
+
+		std::fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+	}
+
+	std::fprintf(file, "\t]\n}\n");
+	std::fclose(file);
+
+	return true;
+}
+
+}}
@@ -0,0 +1,171 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <blink/sampler_draw_cache.hpp>
+#include "bench.hpp"
+
+namespace blink {
+namespace bench {
+
+namespace {
+
+//
+// A seekable stand-in for blink_sampler_draw(). Each column's amp is a
+// function of its position and of the first envelope point's value, and
+// every column which is calculated is counted
+//
+struct MockDraw
+{
+	blink_FrameCount columns_drawn = 0;
+
+	static float amp(blink_Position position, const blink_ParameterData* data)
+	{
+		return float(std::sin(position * 0.001)) * data->envelope.points.points[0].position.y;
+	}
+
+	blink_Error operator()(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out)
+	{
+		for (blink_FrameCount i = 0; i < n; i++)
+		{
+			out->amp[i] = amp(buffer->positions[i], buffer->parameter_data);
+		}
+
+		columns_drawn += n;
+
+		return BLINK_OK;
+	}
+};
+
+struct DrawFixture
+{
+	blink_EnvelopePoint point {};
+	blink_ParameterData data {};
+	blink_SamplerBuffer buffer {};
+	std::vector<blink_Position> positions;
+	std::vector<float> amp;
+
+	DrawFixture()
+	{
+		point.position.y = 1.0f;
+
+		data.envelope.type = blink_ParameterType_Envelope;
+		data.envelope.min = 0.0f;
+		data.envelope.max = 1.0f;
+		data.envelope.points.count = 1;
+		data.envelope.points.points = &point;
+
+		buffer.parameter_data = &data;
+	}
+
+	DrawFixture(const DrawFixture&) = delete;
+	DrawFixture& operator=(const DrawFixture&) = delete;
+
+	// Columns [start], [start + step], [start + (2 * step)], ... calculated
+	// from scratch every time, the way a host lays out the visible range
+	std::string draw(SamplerDrawCache* cache, MockDraw* draw_fn, double start, double step, blink_FrameCount n)
+	{
+		positions.resize(n);
+		amp.assign(n, 0.0f);
+
+		for (blink_FrameCount i = 0; i < n; i++) positions[i] = start + (double(i) * step);
+
+		buffer.positions = positions.data();
+
+		blink_SamplerDrawInfo out {};
+
+		out.amp = amp.data();
+
+		if (cache->draw(&buffer, n, &out, 1, *draw_fn) != BLINK_OK) return "draw() failed";
+
+		for (blink_FrameCount i = 0; i < n; i++)
+		{
+			if (std::abs(amp[i] - MockDraw::amp(positions[i], &data)) > 1.0e-6f) return "column " + std::to_string(i) + " has the wrong amp";
+		}
+
+		return {};
+	}
+};
+
+}
+
+void add_draw_cache_tests(Runner& runner)
+{
+	constexpr blink_FrameCount COLUMNS = 512;
+	constexpr double START = 12345.678;
+	constexpr double STEP = 37.3;
+	constexpr int SCROLL = 10;
+
+	// After scrolling right by a few columns only the new columns on the
+	// right are calculated, even though the host works the positions out
+	// again rather than shifting the old ones
+	runner.add_test("test/draw_cache/scroll", []() -> std::string
+	{
+		SamplerDrawCache cache;
+		MockDraw draw_fn;
+		DrawFixture fixture;
+
+		auto error = fixture.draw(&cache, &draw_fn, START, STEP, COLUMNS);
+
+		if (!error.empty()) return error;
+
+		const auto first = fixture.positions;
+		const auto scroll_start = START + (SCROLL * STEP);
+
+		error = fixture.draw(&cache, &draw_fn, scroll_start, STEP, COLUMNS);
+
+		if (!error.empty()) return error;
+
+		// Make sure the scrolled positions really aren't all bit identical
+		// to the ones they are being matched against
+		int exact = 0;
+
+		for (blink_FrameCount i = 0; i + SCROLL < COLUMNS; i++)
+		{
+			if (first[i + SCROLL] == fixture.positions[i]) exact++;
+		}
+
+		if (exact == COLUMNS - SCROLL) return "scrolled positions are bit identical, the test needs a different step";
+
+		const auto expected = COLUMNS + SCROLL;
+
+		if (draw_fn.columns_drawn != expected)
+		{
+			return std::to_string(draw_fn.columns_drawn) + " columns were drawn, expected " + std::to_string(expected);
+		}
+
+		return {};
+	});
+
+	// Changing the parameter data recalculates every column, even though
+	// the positions haven't moved
+	runner.add_test("test/draw_cache/invalidate", []() -> std::string
+	{
+		SamplerDrawCache cache;
+		MockDraw draw_fn;
+		DrawFixture fixture;
+
+		auto error = fixture.draw(&cache, &draw_fn, START, STEP, COLUMNS);
+
+		if (!error.empty()) return error;
+
+		error = fixture.draw(&cache, &draw_fn, START, STEP, COLUMNS);
+
+		if (!error.empty()) return error;
+		if (draw_fn.columns_drawn != COLUMNS) return "redrawing the same columns calculated them again";
+
+		fixture.point.position.y = 0.5f;
+
+		error = fixture.draw(&cache, &draw_fn, START, STEP, COLUMNS);
+
+		if (!error.empty()) return error;
+
+		if (draw_fn.columns_drawn != COLUMNS * 2)
+		{
+			return std::to_string(draw_fn.columns_drawn - COLUMNS) + " columns were drawn after the envelope changed, expected " + std::to_string(COLUMNS);
+		}
+
+		return {};
+	});
+}
+
+}}
@@ -0,0 +1,273 @@
+#include <memory>
+#include <random>
+#include <blink/chord_parameter.hpp>
+#include <blink/envelope_parameter.hpp>
+#include <blink/standard_parameters.hpp>
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+namespace blink {
+namespace bench {
+
+namespace {
+
+// Ten minutes at 44.1kHz
+constexpr std::int64_t SONG_LENGTH = 44100 * 60 * 10;
+
+enum class Shape
+{
+	// Points spread evenly over the whole song
+	Uniform,
+
+	// All points packed into the first few seconds, so most of the song
+	// lies past the last point
+	Clustered,
+
+	// Pairs of points one frame apart, i.e. a staircase
+	Steps,
+};
+
+enum class Pattern
+{
+	// Every buffer starts after the previous one
+	Forward,
+
+	// Jumps back to the start of a loop every LOOP_BUFFERS buffers
+	Loop,
+
+	// Every buffer starts at a random song position
+	Random,
+};
+
+constexpr int LOOP_BUFFERS = 8;
+
+const char* to_string(Shape shape)
+{
+	switch (shape)
+	{
+		case Shape::Uniform: return "uniform";
+		case Shape::Clustered: return "clustered";
+		case Shape::Steps: return "steps";
+		default: return "";
+	}
+}
+
+const char* to_string(Pattern pattern)
+{
+	switch (pattern)
+	{
+		case Pattern::Forward: return "forward";
+		case Pattern::Loop: return "loop";
+		case Pattern::Random: return "random";
+		default: return "";
+	}
+}
+
+std::vector<std::int64_t> make_point_positions(Shape shape, int count)
+{
+	std::vector<std::int64_t> out(count);
+
+	const auto span = shape == Shape::Clustered ? std::int64_t(44100 * 4) : SONG_LENGTH;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (shape == Shape::Steps)
+		{
+			out[i] = (std::int64_t(i / 2) * span) / std::max(1, count / 2) + (i % 2);
+		}
+		else
+		{
+			out[i] = (std::int64_t(i) * span) / std::max(1, count);
+		}
+	}
+
+	return out;
+}
+
+std::shared_ptr<EnvelopeFixture> make_envelope(Shape shape, int count)
+{
+	auto out = std::make_shared<EnvelopeFixture>(0.0f, 1.0f);
+
+	for (const auto x : make_point_positions(shape, count))
+	{
+		out->add(x, float(out->points.size() % 7) / 6.0f);
+	}
+
+	return out;
+}
+
+std::shared_ptr<ChordFixture> make_chord(Shape shape, int count)
+{
+	auto out = std::make_shared<ChordFixture>();
+
+	for (const auto x : make_point_positions(shape, count))
+	{
+		out->add(x, blink_Scale(out->blocks.size() % 3 == 0 ? 0 : 0x91));
+	}
+
+	return out;
+}
+
+constexpr int NUM_BUFFERS = 1024;
+
+std::shared_ptr<PositionCycle<>> make_position_cycle(Pattern pattern)
+{
+	auto out = std::make_shared<PositionCycle<>>();
+
+	std::mt19937 rng(1);
+
+	const auto stride = SONG_LENGTH / NUM_BUFFERS;
+
+	std::int64_t loop_start = 0;
+
+	BlockPositionsBuilder builder;
+
+	for (int b = 0; b < NUM_BUFFERS; b++)
+	{
+		std::int64_t start = 0;
+
+		switch (pattern)
+		{
+			case Pattern::Forward:
+			{
+				start = b * stride;
+				break;
+			}
+
+			case Pattern::Loop:
+			{
+				if (b % LOOP_BUFFERS == 0) loop_start = b * stride;
+
+				start = loop_start + (std::int64_t(b % LOOP_BUFFERS) * kFloatsPerDSPVector);
+				break;
+			}
+
+			case Pattern::Random:
+			{
+				start = std::uniform_int_distribution<std::int64_t>(0, SONG_LENGTH - kFloatsPerDSPVector)(rng);
+				break;
+			}
+		}
+
+		out->add(builder.next(double(start), 1.0));
+	}
+
+	return out;
+}
+
+std::string case_name(const char* fn, Shape shape, int count, Pattern pattern)
+{
+	return std::string(fn) + "/" + to_string(shape) + "/points=" + std::to_string(count) + "/" + to_string(pattern);
+}
+
+void add_envelope_cases(
+	Runner& runner,
+	const std::shared_ptr<EnvelopeParameter>& envelope,
+	const std::shared_ptr<EnvelopeFixture>& fixture,
+	const std::shared_ptr<PositionCycle<>>& positions,
+	Shape shape,
+	int count,
+	Pattern pattern)
+{
+	const auto default_value = envelope->get_default_value();
+
+	runner.add(case_name("envelope/search_vec", shape, count, pattern), kFloatsPerDSPVector, [=]()
+	{
+		do_not_optimize(envelope->search_vec(&fixture->data, positions->next()));
+	});
+
+	runner.add(case_name("envelope/search", shape, count, pattern), kFloatsPerDSPVector, [=]()
+	{
+		const auto& block_positions = positions->next();
+
+		float sum = 0.0f;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			sum += envelope->search(&fixture->data, blink_Position(block_positions.fixed_positions[i]));
+		}
+
+		do_not_optimize(sum);
+	});
+
+	runner.add(case_name("envelope/generic_search_binary", shape, count, pattern), kFloatsPerDSPVector, [=]()
+	{
+		const auto& block_positions = positions->next();
+
+		float sum = 0.0f;
+		int left = 0;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			sum += std_params::envelopes::generic_search_binary(&fixture->data, default_value, blink_Position(block_positions.fixed_positions[i]), 0, &left);
+		}
+
+		do_not_optimize(sum);
+	});
+
+	// Each search starts from where the last one left off, as it would
+	// inside search_vec()
+	runner.add(case_name("envelope/generic_search_forward", shape, count, pattern), kFloatsPerDSPVector, [=]()
+	{
+		const auto& block_positions = positions->next();
+
+		float sum = 0.0f;
+		int left = 0;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			sum += std_params::envelopes::generic_search_forward(&fixture->data, default_value, blink_Position(block_positions.fixed_positions[i]), left, &left);
+		}
+
+		do_not_optimize(sum);
+	});
+}
+
+void add_chord_cases(
+	Runner& runner,
+	const std::shared_ptr<ChordParameter>& chord,
+	const std::shared_ptr<ChordFixture>& fixture,
+	const std::shared_ptr<PositionCycle<>>& positions,
+	Shape shape,
+	int count,
+	Pattern pattern)
+{
+	runner.add(case_name("chord/search_vec", shape, count, pattern), kFloatsPerDSPVector, [=]()
+	{
+		do_not_optimize(chord->search_vec(&fixture->data, positions->next()));
+	});
+}
+
+}
+
+void add_envelope_benchmarks(Runner& runner)
+{
+	const auto envelope = std::make_shared<EnvelopeParameter>(std_params::envelopes::amp());
+	const auto chord = std::make_shared<ChordParameter>(std_params::chords::scale());
+
+	const std::shared_ptr<PositionCycle<>> positions[] =
+	{
+		make_position_cycle(Pattern::Forward),
+		make_position_cycle(Pattern::Loop),
+		make_position_cycle(Pattern::Random),
+	};
+
+	for (const auto shape : { Shape::Uniform, Shape::Clustered, Shape::Steps })
+	{
+		for (const auto count : { 0, 1, 16, 1000, 100000 })
+		{
+			const auto envelope_fixture = make_envelope(shape, count);
+			const auto chord_fixture = make_chord(shape, count);
+
+			for (const auto pattern : { Pattern::Forward, Pattern::Loop, Pattern::Random })
+			{
+				const auto& pattern_positions = positions[int(pattern)];
+
+				add_envelope_cases(runner, envelope, envelope_fixture, pattern_positions, shape, count, pattern);
+				add_chord_cases(runner, chord, chord_fixture, pattern_positions, shape, count, pattern);
+			}
+		}
+	}
+}
+
+}}
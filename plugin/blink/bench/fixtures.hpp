@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <blink_sampler.h>
+#include <blink/block_positions.hpp>
+
+namespace blink {
+namespace bench {
+
+//
+// Parameter data for the benchmark cases to search. Each fixture owns the
+// points its data refers to so it can't be copied. Build one up with add()
+// before any cases run
+//
+struct EnvelopeFixture
+{
+	std::vector<blink_EnvelopePoint> points;
+	blink_EnvelopeData data {};
+
+	EnvelopeFixture(float min, float max)
+	{
+		data.type = blink_ParameterType_Envelope;
+		data.options = nullptr;
+		data.min = min;
+		data.max = max;
+	}
+
+	EnvelopeFixture(const EnvelopeFixture&) = delete;
+	EnvelopeFixture& operator=(const EnvelopeFixture&) = delete;
+
+	void add(std::int64_t x, float y)
+	{
+		blink_EnvelopePoint point;
+
+		point.position.x = blink_IntPosition(x);
+		point.position.y = y;
+		point.curve = 0.0f;
+
+		points.push_back(point);
+
+		data.points.count = blink_Index(points.size());
+		data.points.points = points.data();
+	}
+};
+
+struct ChordFixture
+{
+	std::vector<blink_ChordBlock> blocks;
+	blink_ChordData data {};
+
+	ChordFixture()
+	{
+		data.type = blink_ParameterType_Chord;
+	}
+
+	ChordFixture(const ChordFixture&) = delete;
+	ChordFixture& operator=(const ChordFixture&) = delete;
+
+	void add(std::int64_t position, blink_Scale scale)
+	{
+		blink_ChordBlock block;
+
+		block.position = blink_IntPosition(position);
+		block.scale = scale;
+
+		blocks.push_back(block);
+
+		data.blocks.count = blink_Index(blocks.size());
+		data.blocks.blocks = blocks.data();
+	}
+};
+
+struct WarpFixture
+{
+	std::vector<blink_WarpPoint> points;
+	blink_WarpPoints data {};
+
+	WarpFixture() = default;
+	WarpFixture(const WarpFixture&) = delete;
+	WarpFixture& operator=(const WarpFixture&) = delete;
+
+	void add(std::int64_t x, std::int64_t y)
+	{
+		points.push_back({ blink_IntPosition(x), blink_IntPosition(y), 0.0f });
+
+		data.count = blink_Index(points.size());
+		data.points = points.data();
+	}
+};
+
+//
+// Builds block positions one buffer at a time. Each buffer is built from
+// the one before it so that the prev_pos values (and therefore the reset
+// points) are the same as they would be when processing
+//
+class BlockPositionsBuilder
+{
+public:
+
+	// [start], [start + step], [start + (2 * step)], ...
+	const BlockPositions& next(double start, double step)
+	{
+		blink_Position positions[kFloatsPerDSPVector];
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) positions[i] = start + (double(i) * step);
+
+		block_positions_(positions, 0, kFloatsPerDSPVector);
+
+		return block_positions_;
+	}
+
+private:
+
+	BlockPositions block_positions_;
+};
+
+//
+// A precomputed cycle of positions so that generating them isn't part of
+// what's being measured
+//
+template <class T = BlockPositions>
+class PositionCycle
+{
+public:
+
+	void add(const T& positions) { items_.push_back(positions); }
+
+	const T& next()
+	{
+		const auto& out = items_[index_];
+
+		index_ = (index_ + 1) % items_.size();
+
+		return out;
+	}
+
+private:
+
+	std::vector<T> items_;
+	std::size_t index_ = 0;
+};
+
+}}
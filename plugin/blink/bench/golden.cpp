@@ -0,0 +1,482 @@
+#include <cmath>
+#include <memory>
+#include <blink/chord_parameter.hpp>
+#include <blink/envelope_parameter.hpp>
+#include <blink/slider_parameter.hpp>
+#include <blink/standard_parameters.hpp>
+#include <blink/standard_traversers/classic.hpp>
+#include <blink/standard_traversers/fudge.hpp>
+#include <blink/unit.hpp>
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+namespace blink {
+namespace bench {
+
+namespace {
+
+// Float outputs (envelopes, sliders, panning, traverser derivatives) are
+// allowed to move by about one part in a million. Positions are checked
+// relative to their size, so the allowed error grows with the position:
+// about a thousandth of a frame thirty seconds in (as far as these cases
+// go) but 0.026 frames ten minutes in
+constexpr double VALUE_TOLERANCE = 1.0e-6;
+constexpr double POSITION_TOLERANCE = 1.0e-9;
+
+constexpr std::int64_t SR = 44100;
+
+//
+// A fixed run of buffers covering the ways the host moves the song
+// position around: normal playback, a loop back to an earlier position,
+// a jump far ahead, playing backwards, half speed, and carrying on past
+// the last envelope point
+//
+std::vector<BlockPositions> make_block_positions()
+{
+	std::vector<BlockPositions> out;
+
+	BlockPositionsBuilder builder;
+
+	const auto add = [&](double start, double step)
+	{
+		out.push_back(builder.next(start, step));
+	};
+
+	// Playback from the start
+	for (int b = 0; b < 32; b++) add(double(b * kFloatsPerDSPVector), 1.0);
+
+	// Loop back and play a bit again
+	for (int b = 8; b < 24; b++) add(double(b * kFloatsPerDSPVector), 1.0);
+
+	// Jump into the middle of the envelopes
+	for (int b = 0; b < 16; b++) add(double((SR * 7) + (b * kFloatsPerDSPVector)), 1.0);
+
+	// Backwards
+	for (int b = 0; b < 16; b++) add(double((SR * 12) - (b * kFloatsPerDSPVector)), -1.0);
+
+	// Half speed
+	for (int b = 0; b < 16; b++) add(double(SR * 3) + (b * kFloatsPerDSPVector * 0.5), 0.5);
+
+	// Past the last point
+	for (int b = 0; b < 16; b++) add(double((SR * 30) + (b * kFloatsPerDSPVector)), 1.0);
+
+	return out;
+}
+
+const std::vector<BlockPositions>& block_positions()
+{
+	static const auto positions = make_block_positions();
+
+	return positions;
+}
+
+std::int64_t num_frames()
+{
+	return std::int64_t(block_positions().size()) * kFloatsPerDSPVector;
+}
+
+//
+// Envelope points spread over the first twenty seconds, stepping through
+// the envelope's default range with a few repeated values and one pair of
+// points at the same position
+//
+std::shared_ptr<EnvelopeFixture> make_envelope(float min, float max, int count)
+{
+	static const float shape[] = { 0.0f, 1.0f, 0.25f, 0.25f, 0.9f, 0.5f, 0.1f };
+
+	auto out = std::make_shared<EnvelopeFixture>(min, max);
+
+	for (int i = 0; i < count; i++)
+	{
+		out->add((std::int64_t(i == 10 ? 9 : i) * SR * 20) / std::max(1, count), min + ((max - min) * shape[i % 7]));
+	}
+
+	return out;
+}
+
+std::shared_ptr<ChordFixture> make_chord(int count)
+{
+	static const blink_Scale scales[] = { 0x91, 0, 0xAB5, 0x49, 0 };
+
+	auto out = std::make_shared<ChordFixture>();
+
+	for (int i = 0; i < count; i++)
+	{
+		out->add((std::int64_t(i) * SR * 20) / std::max(1, count), scales[i % 5]);
+	}
+
+	return out;
+}
+
+std::shared_ptr<WarpFixture> make_warp()
+{
+	auto out = std::make_shared<WarpFixture>();
+
+	out->add(0, 0);
+	out->add(SR, SR / 2);
+	out->add(SR * 4, SR * 5);
+	out->add(SR * 9, SR * 8);
+
+	return out;
+}
+
+void append(Values* out, const float* values, int count)
+{
+	for (int i = 0; i < count; i++) out->push_back(double(values[i]));
+}
+
+void append(Values* out, const FixedPositionVector& positions)
+{
+	for (int i = 0; i < kFloatsPerDSPVector; i++) out->push_back(blink_Position(positions[i]));
+}
+
+//
+// Envelopes
+//
+struct NamedEnvelope
+{
+	const char* name;
+	EnvelopeSpec spec;
+};
+
+// The generic specs leave the UUID and name to the plugin
+EnvelopeSpec generic(EnvelopeSpec spec, const char* name)
+{
+	spec.uuid = name;
+	spec.name = name;
+
+	return spec;
+}
+
+std::vector<NamedEnvelope> std_envelopes()
+{
+	namespace envelopes = std_params::envelopes;
+
+	return {
+		{ "amp", envelopes::amp() },
+		{ "pan", envelopes::pan() },
+		{ "pitch", envelopes::pitch() },
+		{ "speed", envelopes::speed() },
+		{ "formant", envelopes::formant() },
+		{ "noise_amount", envelopes::noise_amount() },
+		{ "noise_color", envelopes::noise_color() },
+		{ "filter_frequency", envelopes::filter_frequency() },
+		{ "resonance", envelopes::resonance() },
+		{ "mix", envelopes::mix() },
+		{ "percentage", generic(envelopes::generic::percentage(), "percentage") },
+		{ "percentage_bipolar", generic(envelopes::generic::percentage_bipolar(), "percentage_bipolar") },
+		{ "linear", generic(envelopes::generic::linear(-10.0f, 10.0f, 1.0f), "linear") },
+	};
+}
+
+void add_envelope_cases(Runner& runner, const NamedEnvelope& envelope)
+{
+	const auto parameter = std::make_shared<EnvelopeParameter>(envelope.spec);
+	const auto min = envelope.spec.range.min.default_value;
+	const auto max = envelope.spec.range.max.default_value;
+	const auto name = std::string("golden/envelope/") + envelope.name;
+
+	for (const auto count : { 0, 1, 24 })
+	{
+		const auto fixture = make_envelope(min, max, count);
+		const auto points = "/points=" + std::to_string(count);
+
+		runner.add_golden(name + points + "/search_vec", num_frames(), [=]()
+		{
+			Values out;
+
+			for (const auto& positions : block_positions())
+			{
+				append(&out, parameter->search_vec(&fixture->data, positions).getConstBuffer(), kFloatsPerDSPVector);
+			}
+
+			return out;
+		}, VALUE_TOLERANCE);
+
+		runner.add_golden(name + points + "/search", num_frames(), [=]()
+		{
+			Values out;
+
+			for (const auto& positions : block_positions())
+			{
+				for (int i = 0; i < kFloatsPerDSPVector; i++)
+				{
+					out.push_back(double(parameter->search(&fixture->data, blink_Position(positions.fixed_positions[i]))));
+				}
+			}
+
+			return out;
+		}, VALUE_TOLERANCE);
+	}
+
+	runner.add_golden(name + "/stepify", 201, [=]()
+	{
+		Values out;
+
+		for (int i = 0; i <= 200; i++)
+		{
+			const auto value = min + ((max - min) * float(i - 50) / 100.0f);
+
+			out.push_back(double(parameter->stepify(value)));
+			out.push_back(double(parameter->snap_value(value, 0.1f, 0.5f)));
+		}
+
+		return out;
+	}, VALUE_TOLERANCE);
+}
+
+//
+// Sliders. Everything the host can do to a slider value through the C API
+//
+template <class T>
+Values render_slider(const Slider<T>& slider, T min, T max)
+{
+	Values out;
+
+	const auto& tweaker = slider.tweaker();
+
+	for (int i = 0; i <= 64; i++)
+	{
+		const auto value = T(double(min) + ((double(max) - double(min)) * double(i - 16) / 32.0));
+
+		out.push_back(double(tweaker.constrain(value)));
+		out.push_back(double(tweaker.stepify(value)));
+
+		for (const auto precise : { false, true })
+		{
+			out.push_back(double(tweaker.increment(value, precise)));
+			out.push_back(double(tweaker.decrement(value, precise)));
+
+			for (const auto amount : { -50, -1, 1, 50 })
+			{
+				out.push_back(double(tweaker.drag(value, amount, precise)));
+			}
+		}
+	}
+
+	return out;
+}
+
+template <class T>
+void add_slider_case(Runner& runner, const char* name, SliderSpec<T> spec, T min, T max)
+{
+	const auto slider = std::make_shared<Slider<T>>(spec);
+
+	runner.add_golden(std::string("golden/slider/") + name, 65, [=]()
+	{
+		return render_slider(*slider, min, max);
+	}, VALUE_TOLERANCE);
+}
+
+template <class T>
+void add_slider_parameter_case(Runner& runner, const char* name, SliderParameterSpec<T> spec, T min, T max)
+{
+	const auto parameter = std::make_shared<SliderParameter<T>>(spec);
+
+	runner.add_golden(std::string("golden/slider_parameter/") + name, 65, [=]()
+	{
+		return render_slider(parameter->slider(), min, max);
+	}, VALUE_TOLERANCE);
+}
+
+void add_slider_cases(Runner& runner)
+{
+	namespace sliders = std_params::sliders;
+
+	add_slider_case(runner, "amp", sliders::amp(), 0.0f, 2.0f);
+	add_slider_case(runner, "pan", sliders::pan(), -1.0f, 1.0f);
+	add_slider_case(runner, "pitch", sliders::pitch(), -60.0f, 60.0f);
+	add_slider_case(runner, "speed", sliders::speed(), 0.0f, 4.0f);
+	add_slider_case(runner, "sample_offset", sliders::sample_offset(), -1000, 1000);
+	add_slider_case(runner, "percentage", sliders::percentage(), 0.0f, 1.0f);
+	add_slider_case(runner, "percentage_bipolar", sliders::percentage_bipolar(), 0.0f, 1.0f);
+	add_slider_case(runner, "filter_frequency", sliders::filter_frequency(), 0.0f, 1.0f);
+	add_slider_case(runner, "linear", sliders::generic::linear(-10.0f, 10.0f, 1.0f, 1.0f), -10.0f, 10.0f);
+
+	add_slider_parameter_case(runner, "amp", sliders::parameters::amp(), 0.0f, 2.0f);
+	add_slider_parameter_case(runner, "pan", sliders::parameters::pan(), -1.0f, 1.0f);
+	add_slider_parameter_case(runner, "pitch", sliders::parameters::pitch(), -60.0f, 60.0f);
+	add_slider_parameter_case(runner, "speed", sliders::parameters::speed(), 0.0f, 4.0f);
+	add_slider_parameter_case(runner, "sample_offset", sliders::parameters::sample_offset(), -1000, 1000);
+	add_slider_parameter_case(runner, "noise_width", sliders::parameters::noise_width(), 0.0f, 1.0f);
+}
+
+//
+// Chords
+//
+void add_chord_cases(Runner& runner)
+{
+	const auto parameter = std::make_shared<ChordParameter>(std_params::chords::scale());
+
+	for (const auto count : { 0, 1, 24 })
+	{
+		const auto fixture = make_chord(count);
+
+		runner.add_golden("golden/chord/scale/blocks=" + std::to_string(count) + "/search_vec", num_frames(), [=]()
+		{
+			Values out;
+
+			for (const auto& positions : block_positions())
+			{
+				const auto scales = parameter->search_vec(&fixture->data, positions);
+
+				for (int i = 0; i < kFloatsPerDSPVector; i++) out.push_back(double(scales[i]));
+			}
+
+			return out;
+		}, 0.0);
+	}
+}
+
+//
+// Unit::stereo_pan()
+//
+void add_stereo_pan_cases(Runner& runner)
+{
+	const auto spec = std_params::envelopes::pan();
+	const auto parameter = std::make_shared<EnvelopeParameter>(spec);
+	const auto fixture = make_envelope(spec.range.min.default_value, spec.range.max.default_value, 24);
+
+	ml::DSPVectorArray<2> in;
+
+	for (int i = 0; i < kFloatsPerDSPVector; i++)
+	{
+		in.getBuffer()[i] = float(std::sin(double(i) * 0.1));
+		in.getBuffer()[kFloatsPerDSPVector + i] = float(std::cos(double(i) * 0.07));
+	}
+
+	for (const auto pan : { -1.0f, -0.5f, 0.0f, 0.3f, 1.0f })
+	{
+		char name[64];
+
+		std::snprintf(name, sizeof(name), "golden/stereo_pan/pan=%g", double(pan));
+
+		runner.add_golden(name, num_frames(), [=]()
+		{
+			Values out;
+
+			for (const auto& positions : block_positions())
+			{
+				append(&out, Unit::stereo_pan(in, pan, *parameter, &fixture->data, positions).getConstBuffer(), kFloatsPerDSPVector * 2);
+			}
+
+			return out;
+		}, VALUE_TOLERANCE);
+	}
+}
+
+//
+// Standard traversers. The traverser and its state carry over from one
+// buffer to the next, as they would in a sampler
+//
+template <class GetPositions>
+Values render_traverser(GetPositions&& get_positions)
+{
+	Values out;
+
+	Traverser traverser;
+
+	for (const auto& positions : block_positions())
+	{
+		traverser.generate(positions);
+
+		get_positions(traverser, &out);
+	}
+
+	return out;
+}
+
+void add_traverser_cases(Runner& runner)
+{
+	const auto pitch_spec = std_params::envelopes::pitch();
+	const auto speed_spec = std_params::envelopes::speed();
+	const auto pitch = make_envelope(-24.0f, 24.0f, 24);
+	const auto speed = make_envelope(0.25f, 2.0f, 24);
+	const auto warp = make_warp();
+
+	for (const auto transpose : { 0.0f, 7.0f })
+	{
+		const auto name = "golden/traverser/classic/transpose=" + std::to_string(int(transpose));
+
+		const auto render = [=](bool derivatives)
+		{
+			std_traversers::Classic classic;
+
+			return render_traverser([&](const Traverser& traverser, Values* out)
+			{
+				FixedPositionVector positions;
+				ml::DSPVector derivatives_vec;
+
+				classic.get_positions(transpose, &pitch->data, traverser, 0, kFloatsPerDSPVector, &positions, &derivatives_vec);
+
+				if (derivatives)
+				{
+					append(out, derivatives_vec.getConstBuffer(), kFloatsPerDSPVector);
+				}
+				else
+				{
+					append(out, positions);
+				}
+			});
+		};
+
+		runner.add_golden(name + "/positions", num_frames(), [=]() { return render(false); }, POSITION_TOLERANCE);
+		runner.add_golden(name + "/derivatives", num_frames(), [=]() { return render(true); }, VALUE_TOLERANCE);
+	}
+
+	runner.add_golden("golden/traverser/fudge/sculpted/positions", num_frames(), [=]()
+	{
+		std_traversers::Fudge fudge;
+
+		return render_traverser([&](const Traverser& traverser, Values* out)
+		{
+			FixedPositionVector positions;
+
+			fudge.get_positions(1.0f, &speed->data, nullptr, traverser, 0, kFloatsPerDSPVector, &positions, nullptr);
+
+			append(out, positions);
+		});
+	}, POSITION_TOLERANCE);
+
+	const auto render_warped = [=](bool derivatives)
+	{
+		std_traversers::Fudge fudge;
+
+		return render_traverser([&](const Traverser& traverser, Values* out)
+		{
+			FixedPositionVector positions;
+			ml::DSPVector derivatives_vec;
+
+			fudge.get_positions(1.0f, &speed->data, &warp->data, traverser, 0, kFloatsPerDSPVector, nullptr, &positions, &derivatives_vec);
+
+			if (derivatives)
+			{
+				append(out, derivatives_vec.getConstBuffer(), kFloatsPerDSPVector);
+			}
+			else
+			{
+				append(out, positions);
+			}
+		});
+	};
+
+	runner.add_golden("golden/traverser/fudge/warped/positions", num_frames(), [=]() { return render_warped(false); }, POSITION_TOLERANCE);
+	runner.add_golden("golden/traverser/fudge/warped/derivatives", num_frames(), [=]() { return render_warped(true); }, VALUE_TOLERANCE);
+}
+
+}
+
+void add_golden_benchmarks(Runner& runner)
+{
+	for (const auto& envelope : std_envelopes())
+	{
+		add_envelope_cases(runner, envelope);
+	}
+
+	add_slider_cases(runner);
+	add_chord_cases(runner);
+	add_stereo_pan_cases(runner);
+	add_traverser_cases(runner);
+}
+
+}}
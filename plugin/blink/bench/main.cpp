@@ -0,0 +1,25 @@
+#include "bench.hpp"
+
+namespace blink {
+namespace bench {
+
+void add_sample_data_benchmarks(Runner& runner);
+void add_envelope_benchmarks(Runner& runner);
+void add_traverser_benchmarks(Runner& runner);
+void add_golden_benchmarks(Runner& runner);
+void add_draw_cache_tests(Runner& runner);
+
+}}
+
+int main(int argc, char** argv)
+{
+	blink::bench::Runner runner(argc, argv);
+
+	blink::bench::add_sample_data_benchmarks(runner);
+	blink::bench::add_envelope_benchmarks(runner);
+	blink::bench::add_traverser_benchmarks(runner);
+	blink::bench::add_golden_benchmarks(runner);
+	blink::bench::add_draw_cache_tests(runner);
+
+	return runner.run();
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace blink {
+namespace bench {
+
+//
+// Hardware performance counters for the calling thread, from Linux
+// perf_event_open(). The counters are opened in pairs, each pair being
+// the numerator and denominator of one of the ratios, as a group so that
+// the kernel only ever schedules both of them together and the ratio
+// comes from one window even when the counters are multiplexed. If a pair
+// can't be opened as a group whatever the CPU (or VM) supports is still
+// opened on its own. Values are scaled up by the time each group was
+// actually counting.
+//
+// On other platforms, or when perf_event_paranoid doesn't allow it,
+// open() returns false and the runner carries on without them.
+//
+class PerfCounters
+{
+public:
+
+	// Each even counter leads a group with the counter after it
+	enum Counter
+	{
+		Cycles,
+		Instructions,
+		Branches,
+		BranchMisses,
+		L1DAccesses,
+		L1DMisses,
+		// Usually the last level cache
+		CacheReferences,
+		CacheMisses,
+
+		NUM_COUNTERS,
+	};
+
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// Returns true if at least one counter could be opened
+	bool open();
+
+	void start();
+	void stop();
+
+	// Value over the most recent start()/stop() period, or a negative
+	// number if the counter isn't available
+	double get(Counter counter) const { return values_[counter]; }
+
+	// IPC, miss rates and per-item counts for the most recent period
+	std::vector<std::pair<std::string, double>> metrics(double num_items) const;
+
+private:
+
+	// Opens one counter, as a group leader if [group_fd] is -1
+	int open_counter(Counter counter, int group_fd) const;
+
+	int fds_[NUM_COUNTERS];
+
+	// Whether fds_ is the leader of its group (or on its own). Counters
+	// which were opened as members are enabled, disabled and read through
+	// their leader
+	bool leader_[NUM_COUNTERS];
+
+	double values_[NUM_COUNTERS];
+};
+
+inline PerfCounters::PerfCounters()
+{
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		fds_[i] = -1;
+		leader_[i] = false;
+		values_[i] = -1.0;
+	}
+}
+
+inline PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+	for (const auto fd : fds_)
+	{
+		if (fd >= 0) close(fd);
+	}
+#endif
+}
+
+inline int PerfCounters::open_counter(Counter counter, int group_fd) const
+{
+#if defined(__linux__)
+	const auto cache = [](std::uint64_t cache, std::uint64_t result)
+	{
+		return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+	};
+
+	const std::pair<std::uint32_t, std::uint64_t> configs[NUM_COUNTERS] =
+	{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		{ PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS) },
+		{ PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	};
+
+	perf_event_attr attr;
+
+	std::memset(&attr, 0, sizeof(attr));
+
+	attr.size = sizeof(attr);
+	attr.type = configs[counter].first;
+	attr.config = configs[counter].second;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	// Members count whenever their leader does
+	attr.disabled = group_fd < 0 ? 1 : 0;
+
+	return int(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+#else
+	return -1;
+#endif
+}
+
+inline bool PerfCounters::open()
+{
+#if defined(__linux__)
+	bool out = false;
+
+	for (int i = 0; i < NUM_COUNTERS; i += 2)
+	{
+		const auto leader = Counter(i);
+		const auto member = Counter(i + 1);
+
+		fds_[leader] = open_counter(leader, -1);
+
+		if (fds_[leader] >= 0)
+		{
+			leader_[leader] = true;
+			fds_[member] = open_counter(member, fds_[leader]);
+		}
+
+		// Counted on its own rather than not at all
+		if (fds_[member] < 0)
+		{
+			fds_[member] = open_counter(member, -1);
+			leader_[member] = fds_[member] >= 0;
+		}
+
+		if (fds_[leader] >= 0 || fds_[member] >= 0) out = true;
+	}
+
+	return out;
+#else
+	return false;
+#endif
+}
+
+inline void PerfCounters::start()
+{
+#if defined(__linux__)
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		if (fds_[i] < 0 || !leader_[i]) continue;
+
+		ioctl(fds_[i], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+#endif
+}
+
+inline void PerfCounters::stop()
+{
+#if defined(__linux__)
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		if (fds_[i] >= 0 && leader_[i]) ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	for (int i = 0; i < NUM_COUNTERS; i++) values_[i] = -1.0;
+
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		if (fds_[i] < 0 || !leader_[i]) continue;
+
+		// Number of counters, time enabled, time running, then the value of
+		// each counter in the order they were added to the group
+		std::uint64_t data[3 + 2];
+
+		const auto size = read(fds_[i], data, sizeof(data));
+
+		if (size < ssize_t(sizeof(std::uint64_t) * 4)) continue;
+
+		// Never got scheduled onto the PMU
+		if (data[2] == 0) continue;
+
+		const auto scale = double(data[1]) / double(data[2]);
+
+		values_[i] = double(data[3]) * scale;
+
+		// The member, if it was opened into this group
+		if (data[0] > 1 && i + 1 < NUM_COUNTERS && !leader_[i + 1] && fds_[i + 1] >= 0)
+		{
+			values_[i + 1] = double(data[4]) * scale;
+		}
+	}
+#endif
+}
+
+inline std::vector<std::pair<std::string, double>> PerfCounters::metrics(double num_items) const
+{
+	std::vector<std::pair<std::string, double>> out;
+
+	const auto have = [this](Counter counter) { return values_[counter] >= 0.0; };
+
+	const auto ratio = [&](const char* name, Counter numerator, Counter denominator)
+	{
+		if (have(numerator) && have(denominator) && values_[denominator] > 0.0)
+		{
+			out.push_back({ name, values_[numerator] / values_[denominator] });
+		}
+	};
+
+	const auto per_item = [&](const char* name, Counter counter)
+	{
+		if (have(counter) && num_items > 0.0)
+		{
+			out.push_back({ name, values_[counter] / num_items });
+		}
+	};
+
+	ratio("ipc", Instructions, Cycles);
+	per_item("cycles_per_item", Cycles);
+	per_item("instructions_per_item", Instructions);
+	ratio("branch_miss_rate", BranchMisses, Branches);
+	per_item("branch_misses_per_item", BranchMisses);
+	ratio("l1d_miss_rate", L1DMisses, L1DAccesses);
+	per_item("l1d_misses_per_item", L1DMisses);
+	ratio("llc_miss_rate", CacheMisses, CacheReferences);
+	per_item("llc_misses_per_item", CacheMisses);
+
+	return out;
+}
+
+}}
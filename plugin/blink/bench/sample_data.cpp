@@ -0,0 +1,272 @@
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <blink/sample_data.hpp>
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+namespace blink {
+namespace bench {
+
+namespace {
+
+//
+// Stands in for the host's sample storage. [callback_cost] adds a fixed
+// amount of busy work to every get_data() call to simulate hosts which have
+// to look the sample up or take a lock before copying
+//
+struct MockSample
+{
+	std::vector<std::vector<float>> channels;
+	int callback_cost = 0;
+	blink_SampleInfo info {};
+
+	MockSample(blink_ChannelCount num_channels, blink_FrameCount num_frames, int callback_cost_)
+		: channels(num_channels, std::vector<float>(num_frames))
+		, callback_cost(callback_cost_)
+	{
+		for (blink_ChannelCount c = 0; c < num_channels; c++)
+		{
+			for (blink_FrameCount i = 0; i < num_frames; i++)
+			{
+				channels[c][i] = float(std::sin(double(i) * 0.01 * double(c + 1)));
+			}
+		}
+
+		info.id = 1;
+		info.num_channels = num_channels;
+		info.num_frames = num_frames;
+		info.SR = 44100;
+		info.bit_depth = 32;
+		info.analysis_ready = BLINK_TRUE;
+		info.host = this;
+		info.get_data = &get_data;
+	}
+
+	static blink_FrameCount get_data(void* host, blink_ChannelCount channel, blink_FrameCount index, blink_FrameCount size, float* buffer)
+	{
+		const auto self = static_cast<MockSample*>(host);
+
+		volatile int work = 0;
+
+		for (int i = 0; i < self->callback_cost; i++) work = work + i;
+
+		const auto& data = self->channels[channel];
+
+		if (index >= data.size()) return 0;
+
+		size = std::min(size, blink_FrameCount(data.size() - index));
+
+		std::copy(data.begin() + index, data.begin() + index + size, buffer);
+
+		return size;
+	}
+};
+
+enum class Pattern
+{
+	Forward,
+	RandomSeek,
+	PitchShifted,
+	Reversed,
+	PastEnd,
+};
+
+const char* to_string(Pattern pattern)
+{
+	switch (pattern)
+	{
+		case Pattern::Forward: return "forward";
+		case Pattern::RandomSeek: return "random";
+		case Pattern::PitchShifted: return "pitch";
+		case Pattern::Reversed: return "reverse";
+		case Pattern::PastEnd: return "past_end";
+		default: return "";
+	}
+}
+
+std::shared_ptr<PositionCycle<FixedPositionVector>> make_position_cycle(Pattern pattern, blink_FrameCount num_frames)
+{
+	constexpr int NUM_VECTORS = 256;
+
+	auto out = std::make_shared<PositionCycle<FixedPositionVector>>();
+
+	std::mt19937 rng(1);
+
+	const auto length = double(num_frames);
+
+	double pos = pattern == Pattern::Reversed ? length - 1.0 : 0.0;
+
+	// PastEnd runs from just before the end of the sample to well past it
+	const auto offset = pattern == Pattern::PastEnd ? std::int64_t(num_frames) - (kFloatsPerDSPVector * NUM_VECTORS / 4) : 0;
+
+	for (int v = 0; v < NUM_VECTORS; v++)
+	{
+		if (pattern == Pattern::RandomSeek)
+		{
+			pos = std::uniform_real_distribution<double>(0.0, length - kFloatsPerDSPVector - 1.0)(rng);
+		}
+
+		FixedPositionVector vec;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			vec.set(i, pos);
+
+			switch (pattern)
+			{
+				case Pattern::PitchShifted: pos += 1.4983; break;
+				case Pattern::Reversed: pos -= 1.0; break;
+				case Pattern::PastEnd: pos += 1.0; break;
+				default: pos += 1.0; break;
+			}
+
+			// Stay inside the sample, except for PastEnd which is used to
+			// exercise the loop wrapping
+			if (pattern != Pattern::PastEnd)
+			{
+				if (pos >= length - 1.0) pos = 0.0;
+				if (pos < 0.0) pos = length - 1.0;
+			}
+		}
+
+		out->add(vec + offset);
+	}
+
+	return out;
+}
+
+struct Config
+{
+	blink_FrameCount num_frames;
+	int callback_cost;
+};
+
+std::string case_name(const char* fn, const char* variant, Pattern pattern, const Config& config)
+{
+	return std::string("sample_data/") + fn + "/" + variant + "/" + to_string(pattern) +
+		"/frames=" + std::to_string(config.num_frames) +
+		"/cost=" + std::to_string(config.callback_cost);
+}
+
+// Mock samples are shared by every case with the same config
+std::shared_ptr<MockSample> get_mock_sample(const Config& config)
+{
+	static std::map<std::pair<blink_FrameCount, int>, std::shared_ptr<MockSample>> samples;
+
+	auto& sample = samples[{ config.num_frames, config.callback_cost }];
+
+	if (!sample) sample = std::make_shared<MockSample>(2, config.num_frames, config.callback_cost);
+
+	return sample;
+}
+
+void add_cases(Runner& runner, const Config& config)
+{
+	const auto sample = get_mock_sample(config);
+
+	const auto stereo = std::make_shared<SampleData>(&sample->info, blink_ChannelMode_Stereo);
+
+	for (const auto pattern : { Pattern::Forward, Pattern::RandomSeek, Pattern::PitchShifted, Pattern::Reversed })
+	{
+		auto positions = make_position_cycle(pattern, config.num_frames);
+
+		runner.add(case_name("read_frames", "mono", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			do_not_optimize(stereo->read_frames(0, positions->next().frames()));
+		});
+
+		runner.add(case_name("read_frames_interp", "mono", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			do_not_optimize(stereo->read_frames_interp(0, positions->next(), false));
+		});
+
+		runner.add(case_name("read_frames_interp", "stereo", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			do_not_optimize(stereo->read_frames_interp<2>(positions->next(), false));
+		});
+
+		runner.add(case_name("read_frame_interp", "mono", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			const auto& vec = positions->next();
+
+			float sum = 0.0f;
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				sum += stereo->read_frame_interp(0, vec[i]);
+			}
+
+			do_not_optimize(sum);
+		});
+	}
+
+	for (const auto pattern : { Pattern::PastEnd, Pattern::PitchShifted })
+	{
+		auto positions = make_position_cycle(pattern, config.num_frames);
+
+		runner.add(case_name("read_frames_interp", "looped", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			do_not_optimize(stereo->read_frames_interp(0, positions->next(), true));
+		});
+
+		runner.add(case_name("read_frames_interp", "stereo_looped", pattern, config), kFloatsPerDSPVector, [=]()
+		{
+			do_not_optimize(stereo->read_frames_interp<2>(positions->next(), true));
+		});
+	}
+}
+
+//
+// Looping over an empty sample has nothing to wrap around. Every read
+// should come back silent (rather than dividing by zero)
+//
+void add_empty_sample_tests(Runner& runner)
+{
+	const auto sample = std::make_shared<MockSample>(2, 0, 0);
+
+	runner.add_test("test/sample_data/empty_loop", [=]() -> std::string
+	{
+		const SampleData data(&sample->info, blink_ChannelMode_Stereo);
+
+		FixedPositionVector positions;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) positions.set(i, (double(i) - 32.0) * 1.5);
+
+		const auto mono = data.read_frames_interp(0, positions, true);
+		const auto stereo = data.read_frames_interp<2>(positions, true);
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			if (mono[i] != 0.0f) return "read_frames_interp() returned a non-zero frame";
+			if (data.read_frame_interp(0, positions[i], true) != 0.0f) return "read_frame_interp() returned a non-zero frame";
+		}
+
+		for (int i = 0; i < kFloatsPerDSPVector * 2; i++)
+		{
+			if (stereo.getConstBuffer()[i] != 0.0f) return "read_frames_interp<2>() returned a non-zero frame";
+		}
+
+		return {};
+	});
+}
+
+}
+
+void add_sample_data_benchmarks(Runner& runner)
+{
+	add_empty_sample_tests(runner);
+
+	// One second and one minute at 44.1kHz, with a free and an expensive
+	// host callback
+	for (const auto num_frames : { blink_FrameCount(44100), blink_FrameCount(44100 * 60) })
+	{
+		for (const auto callback_cost : { 0, 50 })
+		{
+			add_cases(runner, { num_frames, callback_cost });
+		}
+	}
+}
+
+}}
@@ -0,0 +1,865 @@
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <blink/standard_traversers/classic.hpp>
+#include <blink/standard_traversers/fudge.hpp>
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+namespace blink {
+namespace bench {
+
+namespace {
+
+using Real = long double;
+
+// Thirty minutes at 44.1kHz
+constexpr std::int64_t SONG_LENGTH = std::int64_t(44100) * 60 * 30;
+
+enum class EnvelopeKind
+{
+	Pitch,
+	Speed,
+};
+
+struct EnvelopeDensity
+{
+	const char* name;
+	int count;
+};
+
+// Flat, a handful of points, and a point every 4096 frames
+const EnvelopeDensity ENVELOPE_DENSITIES[] =
+{
+	{ "flat", 0 },
+	{ "sparse", 16 },
+	{ "dense", int(SONG_LENGTH / 4096) },
+};
+
+const EnvelopeDensity WARP_DENSITIES[] =
+{
+	{ "no_warp", 0 },
+	{ "sparse_warp", 16 },
+	{ "dense_warp", 10000 },
+};
+
+std::shared_ptr<EnvelopeFixture> make_envelope(EnvelopeKind kind, int count)
+{
+	static const float pitches[] = { 0.0f, 12.0f, -7.0f, 24.0f, -24.0f, 3.5f };
+	static const float speeds[] = { 1.0f, 2.0f, 0.5f, 1.5f, 0.25f, 1.0f };
+
+	auto out = kind == EnvelopeKind::Pitch
+		? std::make_shared<EnvelopeFixture>(-60.0f, 60.0f)
+		: std::make_shared<EnvelopeFixture>(0.0f, 4.0f);
+
+	for (int i = 0; i < count; i++)
+	{
+		out->add((std::int64_t(i) * SONG_LENGTH) / count, kind == EnvelopeKind::Pitch ? pitches[i % 6] : speeds[i % 6]);
+	}
+
+	return out;
+}
+
+std::shared_ptr<WarpFixture> make_warp(int count)
+{
+	auto out = std::make_shared<WarpFixture>();
+
+	// Sculpted positions (y) run up to about twice the song length to
+	// cover the fastest speed envelope. Alternate segments are stretched
+	// and squashed
+	std::int64_t y = 0;
+	std::int64_t prev_x = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		const auto x = (std::int64_t(i) * SONG_LENGTH * 2) / count;
+
+		y += (i % 2 == 0) ? ((x - prev_x) * 4) / 5 : ((x - prev_x) * 5) / 4;
+
+		out->add(x, y);
+
+		prev_x = x;
+	}
+
+	return out;
+}
+
+//
+// High precision references. These evaluate the same models as the
+// calculators, in long double, from cumulative segment start values so that
+// any position can be looked up directly
+//
+
+// Classic: the frequency factor is a geometric series over each segment
+class ClassicReference
+{
+public:
+
+	ClassicReference(const blink_EnvelopeData& envelope, float transpose)
+		: transpose_(transpose)
+	{
+		for (blink_Index i = 0; i < envelope.points.count; i++)
+		{
+			const auto& p = envelope.points.points[i];
+
+			xs_.push_back(p.position.x);
+			pitches_.push_back(Real(std::clamp(p.position.y, envelope.min, envelope.max)) + transpose);
+		}
+
+		flat_ff_ = ff(Real(std::clamp(0.0f, envelope.min, envelope.max)) + transpose);
+
+		if (xs_.empty()) return;
+
+		starts_.push_back(Real(xs_[0]) * ff(pitches_[0]));
+
+		for (std::size_t i = 1; i < xs_.size(); i++)
+		{
+			const auto size = Real(xs_[i] - xs_[i - 1]);
+
+			starts_.push_back(starts_[i - 1] + (size > 0 ? sum(pitches_[i - 1], pitches_[i], size, size) : Real(0)));
+		}
+	}
+
+	Real operator()(Real x) const
+	{
+		if (xs_.empty()) return x * flat_ff_;
+		if (x < xs_[0]) return x * ff(pitches_[0]);
+
+		const auto k = std::size_t(std::upper_bound(xs_.begin(), xs_.end(), x) - xs_.begin()) - 1;
+		const auto n = x - xs_[k];
+
+		if (k + 1 == xs_.size()) return starts_[k] + (n * ff(pitches_[k]));
+
+		return starts_[k] + sum(pitches_[k], pitches_[k + 1], Real(xs_[k + 1] - xs_[k]), n);
+	}
+
+private:
+
+	static Real ff(Real p) { return std::pow(Real(2), p / Real(12)); }
+
+	static Real sum(Real p0, Real p1, Real size, Real n)
+	{
+		const auto r = std::pow(Real(2), ((p1 - p0) / size) / Real(12));
+
+		if (r == Real(1)) return n * ff(p0);
+
+		return ff(p0) * ((Real(1) - std::pow(r, n)) / (Real(1) - r));
+	}
+
+	float transpose_;
+	Real flat_ff_;
+	std::vector<std::int64_t> xs_;
+	std::vector<Real> pitches_;
+	std::vector<Real> starts_;
+};
+
+// Fudge: the frequency factor is linear over each segment
+class FudgeReference
+{
+public:
+
+	FudgeReference(const blink_EnvelopeData& envelope, float speed)
+	{
+		for (blink_Index i = 0; i < envelope.points.count; i++)
+		{
+			const auto& p = envelope.points.points[i];
+
+			xs_.push_back(p.position.x);
+			ffs_.push_back(Real(std::clamp(p.position.y, envelope.min, envelope.max)) * speed);
+		}
+
+		flat_ff_ = Real(std::clamp(1.0f, envelope.min, envelope.max)) * speed;
+
+		if (xs_.empty()) return;
+
+		starts_.push_back(Real(xs_[0]) * ffs_[0]);
+
+		for (std::size_t i = 1; i < xs_.size(); i++)
+		{
+			const auto size = Real(xs_[i] - xs_[i - 1]);
+
+			starts_.push_back(starts_[i - 1] + (size > 0 ? integral(ffs_[i - 1], ffs_[i], size, size) : Real(0)));
+		}
+	}
+
+	Real operator()(Real x) const
+	{
+		if (xs_.empty()) return x * flat_ff_;
+		if (x < xs_[0]) return x * ffs_[0];
+
+		const auto k = std::size_t(std::upper_bound(xs_.begin(), xs_.end(), x) - xs_.begin()) - 1;
+		const auto n = x - xs_[k];
+
+		if (k + 1 == xs_.size()) return starts_[k] + (n * ffs_[k]);
+
+		return starts_[k] + integral(ffs_[k], ffs_[k + 1], Real(xs_[k + 1] - xs_[k]), n);
+	}
+
+private:
+
+	static Real integral(Real f0, Real f1, Real size, Real n)
+	{
+		return (f0 * n) + (((f1 - f0) / (Real(2) * size)) * n * n);
+	}
+
+	Real flat_ff_;
+	std::vector<std::int64_t> xs_;
+	std::vector<Real> ffs_;
+	std::vector<Real> starts_;
+};
+
+// Warp: piecewise linear mapping from sculpted (y) to warped (x) positions
+class WarpReference
+{
+public:
+
+	WarpReference(const blink_WarpPoints& warp_points)
+		: points_(warp_points.points, warp_points.points + warp_points.count)
+	{
+	}
+
+	Real operator()(Real y) const
+	{
+		if (points_.empty()) return y;
+		if (points_.size() == 1) return y - Real(points_[0].y - points_[0].x);
+		if (y < points_[0].y) return points_[0].x + (y - points_[0].y);
+
+		const auto less = [](Real y, const blink_WarpPoint& p) { return y < p.y; };
+		const auto k = std::size_t(std::upper_bound(points_.begin(), points_.end(), y, less) - points_.begin()) - 1;
+
+		const auto& p0 = points_[k];
+
+		if (k + 1 == points_.size()) return p0.x + (y - p0.y);
+
+		const auto& p1 = points_[k + 1];
+
+		return Real(p0.x) + (Real(p1.x - p0.x) * ((y - p0.y) / Real(p1.y - p0.y)));
+	}
+
+private:
+
+	std::vector<blink_WarpPoint> points_;
+};
+
+//
+// Block position scenarios
+//
+struct Scenario
+{
+	const char* name;
+
+	// Song position of the first buffer
+	std::int64_t start;
+
+	// Distance between positions within a buffer. Greater than one when
+	// drawing a zoomed out waveform
+	std::int64_t spacing;
+
+	// Jump back to the start every [loop] buffers (zero for never)
+	int loop;
+
+	// Start every buffer with a freshly constructed traverser, as when a
+	// waveform is drawn starting far off the left edge of the screen
+	bool fresh;
+};
+
+const Scenario SCENARIOS[] =
+{
+	{ "playback", 0, 1, 0, false },
+	{ "late_playback", SONG_LENGTH - (SONG_LENGTH / 8), 1, 0, false },
+	{ "loop4", SONG_LENGTH / 2, 1, 4, false },
+	{ "waveform", 0, 1024, 0, false },
+	{ "offscreen_waveform", SONG_LENGTH / 2, 1024, 0, true },
+};
+
+std::shared_ptr<PositionCycle<>> make_position_cycle(const Scenario& scenario)
+{
+	constexpr int NUM_BUFFERS = 1024;
+
+	auto out = std::make_shared<PositionCycle<>>();
+
+	BlockPositionsBuilder builder;
+
+	const auto buffer_length = scenario.spacing * kFloatsPerDSPVector;
+
+	for (int b = 0; b < NUM_BUFFERS; b++)
+	{
+		const auto index = scenario.loop > 0 ? b % scenario.loop : b;
+		const auto start = (scenario.start + (index * buffer_length)) % SONG_LENGTH;
+
+		out->add(builder.next(double(start), double(scenario.spacing)));
+	}
+
+	return out;
+}
+
+//
+// Throughput
+//
+
+// Sequential positions for the scalar calculator cases, wrapping (and
+// resetting the calculator) at the end of the song
+struct Cursor
+{
+	std::int64_t position = 0;
+
+	template <class Calculator>
+	blink_Position next(Calculator* calculator)
+	{
+		if (++position >= SONG_LENGTH)
+		{
+			position = 0;
+			calculator->reset();
+		}
+
+		return blink_Position(position);
+	}
+};
+
+void add_calculator_cases(Runner& runner, const std::shared_ptr<EnvelopeFixture>& pitch, const std::shared_ptr<EnvelopeFixture>& speed, const char* density)
+{
+	// The calculators are only used when there are envelope points
+	if (pitch->data.points.count < 1) return;
+
+	{
+		auto calculator = std::make_shared<std_traversers::ClassicCalculator>();
+		auto cursor = std::make_shared<Cursor>();
+
+		runner.add(std::string("traversers/classic_calculator/calculate/") + density, kFloatsPerDSPVector, [=]()
+		{
+			blink_Position sum = 0.0;
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				sum += calculator->calculate(0.0f, &pitch->data, cursor->next(calculator.get()));
+			}
+
+			do_not_optimize(sum);
+		});
+	}
+
+	{
+		auto calculator = std::make_shared<std_traversers::FudgeCalculator>();
+		auto cursor = std::make_shared<Cursor>();
+
+		runner.add(std::string("traversers/fudge_calculator/calculate/") + density, kFloatsPerDSPVector, [=]()
+		{
+			blink_Position sum = 0.0;
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				sum += calculator->calculate(1.0f, &speed->data, cursor->next(calculator.get()));
+			}
+
+			do_not_optimize(sum);
+		});
+	}
+}
+
+void add_warp_calculator_cases(Runner& runner, const std::shared_ptr<WarpFixture>& warp, const char* density)
+{
+	if (warp->data.count < 1) return;
+
+	auto calculator = std::make_shared<std_traversers::WarpCalculator>();
+	auto position = std::make_shared<std::int64_t>(0);
+
+	runner.add(std::string("traversers/warp_calculator/calculate/") + density, kFloatsPerDSPVector, [=]()
+	{
+		blink_Position sum = 0.0;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			if (++(*position) >= SONG_LENGTH * 2)
+			{
+				*position = 0;
+				calculator->reset();
+			}
+
+			sum += calculator->calculate(&warp->data, blink_Position(*position));
+		}
+
+		do_not_optimize(sum);
+	});
+}
+
+void add_classic_cases(Runner& runner, const std::shared_ptr<EnvelopeFixture>& pitch, const char* density, const Scenario& scenario, const std::shared_ptr<PositionCycle<>>& positions)
+{
+	struct State
+	{
+		std_traversers::Classic classic;
+		Traverser traverser;
+	};
+
+	auto state = std::make_shared<State>();
+
+	const auto name = std::string("traversers/classic/get_positions/") + density + "/" + scenario.name;
+
+	runner.add(name, kFloatsPerDSPVector, [=]()
+	{
+		if (scenario.fresh) state->classic = std_traversers::Classic();
+
+		state->traverser.generate(positions->next());
+
+		FixedPositionVector out;
+
+		state->classic.get_positions(0.0f, &pitch->data, state->traverser, 0, kFloatsPerDSPVector, &out);
+
+		do_not_optimize(out);
+	});
+}
+
+void add_fudge_cases(
+	Runner& runner,
+	const std::shared_ptr<EnvelopeFixture>& speed,
+	const std::shared_ptr<WarpFixture>& warp,
+	const char* density,
+	const char* warp_density,
+	const Scenario& scenario,
+	const std::shared_ptr<PositionCycle<>>& positions)
+{
+	struct State
+	{
+		std_traversers::Fudge fudge;
+		Traverser traverser;
+	};
+
+	const auto name = std::string("traversers/fudge/get_positions/") + density + "/" + warp_density + "/" + scenario.name;
+
+	// Sculpted positions only. The warp stage is skipped so this only needs
+	// to run once per speed envelope, not for every warp density
+	if (warp->data.count < 1)
+	{
+		auto state = std::make_shared<State>();
+
+		runner.add(name + "/sculpted", kFloatsPerDSPVector, [=]()
+		{
+			if (scenario.fresh) state->fudge = std_traversers::Fudge();
+
+			state->traverser.generate(positions->next());
+
+			FixedPositionVector sculpted;
+
+			state->fudge.get_positions(1.0f, &speed->data, &warp->data, state->traverser, 0, kFloatsPerDSPVector, &sculpted, nullptr);
+
+			do_not_optimize(sculpted);
+		});
+	}
+
+	auto state = std::make_shared<State>();
+
+	runner.add(name + "/warped_derivatives", kFloatsPerDSPVector, [=]()
+	{
+		if (scenario.fresh) state->fudge = std_traversers::Fudge();
+
+		state->traverser.generate(positions->next());
+
+		FixedPositionVector warped;
+		ml::DSPVector derivatives;
+
+		state->fudge.get_positions(1.0f, &speed->data, &warp->data, state->traverser, 0, kFloatsPerDSPVector, nullptr, &warped, &derivatives);
+
+		do_not_optimize(warped);
+		do_not_optimize(derivatives);
+	});
+}
+
+//
+// Envelopes with a point every few frames split each buffer into runs of
+// one to four positions. The per_position cases evaluate every position with
+// a calculate() call, which is how get_positions() worked before same-segment
+// runs were evaluated together, so the two can be compared directly
+//
+void add_short_run_cases(Runner& runner, const Scenario& scenario, const std::shared_ptr<PositionCycle<>>& positions)
+{
+	// Covers every buffer of the position cycle
+	constexpr std::int64_t LENGTH = std::int64_t(1024) * kFloatsPerDSPVector;
+
+	auto pitch = std::make_shared<EnvelopeFixture>(-60.0f, 60.0f);
+	auto speed = std::make_shared<EnvelopeFixture>(0.0f, 4.0f);
+
+	for (std::int64_t x = 0, i = 0; x < LENGTH; x += 1 + (i % 4), i++)
+	{
+		pitch->add(scenario.start + x, float(i % 13) - 6.0f);
+		speed->add(scenario.start + x, 0.5f + (float(i % 7) * 0.25f));
+	}
+
+	const auto name = [&](const char* traverser, const char* method)
+	{
+		return std::string("traversers/") + traverser + "/" + method + "/short_runs/" + scenario.name;
+	};
+
+	{
+		struct State
+		{
+			std_traversers::Classic classic;
+			Traverser traverser;
+		};
+
+		auto state = std::make_shared<State>();
+
+		runner.add(name("classic", "get_positions"), kFloatsPerDSPVector, [=]()
+		{
+			state->traverser.generate(positions->next());
+
+			FixedPositionVector out;
+
+			state->classic.get_positions(0.0f, &pitch->data, state->traverser, 0, kFloatsPerDSPVector, &out);
+
+			do_not_optimize(out);
+		});
+	}
+
+	{
+		struct State
+		{
+			std_traversers::ClassicCalculator calculator;
+			Traverser traverser;
+		};
+
+		auto state = std::make_shared<State>();
+
+		runner.add(name("classic", "per_position"), kFloatsPerDSPVector, [=]()
+		{
+			state->traverser.generate(positions->next());
+
+			const auto& block_positions = state->traverser.block_positions();
+
+			FixedPositionVector out;
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				if (state->traverser.is_reset(i)) state->calculator.reset();
+
+				out.set(i, state->calculator.calculate(0.0f, &pitch->data, block_positions.fixed_positions[i]));
+			}
+
+			do_not_optimize(out);
+		});
+	}
+
+	{
+		struct State
+		{
+			std_traversers::Fudge fudge;
+			Traverser traverser;
+		};
+
+		auto state = std::make_shared<State>();
+
+		runner.add(name("fudge", "get_positions"), kFloatsPerDSPVector, [=]()
+		{
+			state->traverser.generate(positions->next());
+
+			FixedPositionVector out;
+
+			state->fudge.get_positions(1.0f, &speed->data, nullptr, state->traverser, 0, kFloatsPerDSPVector, &out, nullptr);
+
+			do_not_optimize(out);
+		});
+	}
+
+	{
+		struct State
+		{
+			std_traversers::FudgeCalculator calculator;
+			Traverser traverser;
+		};
+
+		auto state = std::make_shared<State>();
+
+		runner.add(name("fudge", "per_position"), kFloatsPerDSPVector, [=]()
+		{
+			state->traverser.generate(positions->next());
+
+			const auto& block_positions = state->traverser.block_positions();
+
+			FixedPositionVector out;
+
+			for (int i = 0; i < kFloatsPerDSPVector; i++)
+			{
+				if (state->traverser.is_reset(i)) state->calculator.reset();
+
+				out.set(i, state->calculator.calculate(1.0f, &speed->data, block_positions.fixed_positions[i]));
+			}
+
+			do_not_optimize(out);
+		});
+	}
+}
+
+//
+// Precision
+//
+struct ErrorStats
+{
+	Real max_abs = 0;
+	Real max_rel = 0;
+	Real last_abs = 0;
+	std::int64_t count = 0;
+
+	void add(Real value, Real reference)
+	{
+		const auto abs = std::abs(value - reference);
+
+		max_abs = std::max(max_abs, abs);
+		max_rel = std::max(max_rel, abs / std::max(std::abs(reference), Real(1)));
+		last_abs = abs;
+		count++;
+	}
+
+	Metrics metrics() const
+	{
+		return {
+			{ "max_abs_error_frames", double(max_abs) },
+			{ "max_rel_error", double(max_rel) },
+			{ "final_abs_error_frames", double(last_abs) },
+			{ "positions_checked", double(count) },
+		};
+	}
+};
+
+// Every position from the start of the song to the end, one buffer at a
+// time. Three positions from each buffer are checked against the reference
+template <class GetPositions, class Reference>
+Metrics check_playback(GetPositions&& get_positions, Reference&& reference)
+{
+	ErrorStats errors;
+	Traverser traverser;
+	BlockPositions block_positions;
+
+	for (std::int64_t start = 0; start + kFloatsPerDSPVector <= SONG_LENGTH; start += kFloatsPerDSPVector)
+	{
+		blink_Position positions[kFloatsPerDSPVector];
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) positions[i] = blink_Position(start + i);
+
+		block_positions(positions, 0, kFloatsPerDSPVector);
+		traverser.generate(block_positions);
+
+		FixedPositionVector out;
+
+		get_positions(traverser, &out);
+
+		for (const auto i : { 0, kFloatsPerDSPVector / 2, kFloatsPerDSPVector - 1 })
+		{
+			errors.add(Real(blink_Position(out[i])), reference(Real(start + i)));
+		}
+	}
+
+	return errors.metrics();
+}
+
+// Single buffers at random positions in the second half of the song, each
+// with a fresh traverser
+template <class MakeGetPositions, class Reference>
+Metrics check_offscreen(MakeGetPositions&& make_get_positions, Reference&& reference)
+{
+	ErrorStats errors;
+	std::mt19937 rng(1);
+
+	for (int n = 0; n < 1000; n++)
+	{
+		const auto start = std::uniform_int_distribution<std::int64_t>(SONG_LENGTH / 2, SONG_LENGTH - (kFloatsPerDSPVector * 1024))(rng);
+
+		blink_Position positions[kFloatsPerDSPVector];
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) positions[i] = blink_Position(start + (i * 1024));
+
+		BlockPositions block_positions;
+		Traverser traverser;
+
+		block_positions(positions, 0, kFloatsPerDSPVector);
+		traverser.generate(block_positions);
+
+		auto get_positions = make_get_positions();
+
+		FixedPositionVector out;
+
+		get_positions(traverser, &out);
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			errors.add(Real(blink_Position(out[i])), reference(Real(start + (i * 1024))));
+		}
+	}
+
+	return errors.metrics();
+}
+
+// Scalar calculate() calls walking forwards through the song
+template <class Calculate, class Reference>
+Metrics check_calculator(Calculate&& calculate, Reference&& reference, std::int64_t length)
+{
+	ErrorStats errors;
+
+	for (std::int64_t x = 0; x < length; x += 997)
+	{
+		errors.add(Real(calculate(blink_Position(x))), reference(Real(x)));
+	}
+
+	return errors.metrics();
+}
+
+void add_precision_checks(Runner& runner, const std::shared_ptr<EnvelopeFixture>& pitch, const std::shared_ptr<EnvelopeFixture>& speed, const char* density)
+{
+	const auto classic_reference = std::make_shared<ClassicReference>(pitch->data, 0.0f);
+	const auto fudge_reference = std::make_shared<FudgeReference>(speed->data, 1.0f);
+
+	const auto song_buffers = SONG_LENGTH / kFloatsPerDSPVector;
+
+	if (pitch->data.points.count > 0)
+	{
+		runner.add_check(std::string("precision/classic_calculator/") + density, SONG_LENGTH / 997, [=]()
+		{
+			std_traversers::ClassicCalculator calculator;
+
+			return check_calculator([&](blink_Position x) { return calculator.calculate(0.0f, &pitch->data, x); }, *classic_reference, SONG_LENGTH);
+		});
+
+		runner.add_check(std::string("precision/fudge_calculator/") + density, SONG_LENGTH / 997, [=]()
+		{
+			std_traversers::FudgeCalculator calculator;
+
+			return check_calculator([&](blink_Position x) { return calculator.calculate(1.0f, &speed->data, x); }, *fudge_reference, SONG_LENGTH);
+		});
+	}
+
+	runner.add_check(std::string("precision/classic/playback/") + density, song_buffers * kFloatsPerDSPVector, [=]()
+	{
+		std_traversers::Classic classic;
+
+		const auto get_positions = [&](const Traverser& traverser, FixedPositionVector* out)
+		{
+			classic.get_positions(0.0f, &pitch->data, traverser, 0, kFloatsPerDSPVector, out);
+		};
+
+		return check_playback(get_positions, *classic_reference);
+	});
+
+	runner.add_check(std::string("precision/classic/offscreen/") + density, 1000 * kFloatsPerDSPVector, [=]()
+	{
+		const auto make_get_positions = [&]()
+		{
+			return [&, classic = std::make_shared<std_traversers::Classic>()](const Traverser& traverser, FixedPositionVector* out)
+			{
+				classic->get_positions(0.0f, &pitch->data, traverser, 0, kFloatsPerDSPVector, out);
+			};
+		};
+
+		return check_offscreen(make_get_positions, *classic_reference);
+	});
+
+	runner.add_check(std::string("precision/fudge/playback/") + density, song_buffers * kFloatsPerDSPVector, [=]()
+	{
+		std_traversers::Fudge fudge;
+
+		const auto get_positions = [&](const Traverser& traverser, FixedPositionVector* out)
+		{
+			fudge.get_positions(1.0f, &speed->data, nullptr, traverser, 0, kFloatsPerDSPVector, out, nullptr);
+		};
+
+		return check_playback(get_positions, *fudge_reference);
+	});
+
+	runner.add_check(std::string("precision/fudge/offscreen/") + density, 1000 * kFloatsPerDSPVector, [=]()
+	{
+		const auto make_get_positions = [&]()
+		{
+			return [&, fudge = std::make_shared<std_traversers::Fudge>()](const Traverser& traverser, FixedPositionVector* out)
+			{
+				fudge->get_positions(1.0f, &speed->data, nullptr, traverser, 0, kFloatsPerDSPVector, out, nullptr);
+			};
+		};
+
+		return check_offscreen(make_get_positions, *fudge_reference);
+	});
+}
+
+void add_warp_calculator_check(Runner& runner, const std::shared_ptr<WarpFixture>& warp, const char* warp_density)
+{
+	if (warp->data.count < 1) return;
+
+	const auto reference = std::make_shared<WarpReference>(warp->data);
+
+	runner.add_check(std::string("precision/warp_calculator/") + warp_density, (SONG_LENGTH * 2) / 997, [=]()
+	{
+		std_traversers::WarpCalculator calculator;
+
+		return check_calculator([&](blink_Position x) { return calculator.calculate(&warp->data, x); }, *reference, SONG_LENGTH * 2);
+	});
+}
+
+void add_warp_precision_checks(Runner& runner, const std::shared_ptr<EnvelopeFixture>& speed, const std::shared_ptr<WarpFixture>& warp, const char* density, const char* warp_density)
+{
+	if (warp->data.count < 1) return;
+
+	const auto fudge_reference = std::make_shared<FudgeReference>(speed->data, 1.0f);
+	const auto warp_reference = std::make_shared<WarpReference>(warp->data);
+
+	runner.add_check(std::string("precision/fudge/playback/") + density + "/" + warp_density, SONG_LENGTH, [=]()
+	{
+		std_traversers::Fudge fudge;
+
+		const auto get_positions = [&](const Traverser& traverser, FixedPositionVector* out)
+		{
+			fudge.get_positions(1.0f, &speed->data, &warp->data, traverser, 0, kFloatsPerDSPVector, nullptr, out);
+		};
+
+		const auto reference = [&](Real x) { return (*warp_reference)((*fudge_reference)(x)); };
+
+		return check_playback(get_positions, reference);
+	});
+}
+
+}
+
+void add_traverser_benchmarks(Runner& runner)
+{
+	std::vector<std::shared_ptr<PositionCycle<>>> positions;
+
+	for (const auto& scenario : SCENARIOS)
+	{
+		positions.push_back(make_position_cycle(scenario));
+	}
+
+	// SCENARIOS[0] is regular playback from the start of the song
+	add_short_run_cases(runner, SCENARIOS[0], positions[0]);
+
+	std::vector<std::shared_ptr<WarpFixture>> warps;
+
+	for (const auto& warp_density : WARP_DENSITIES)
+	{
+		warps.push_back(make_warp(warp_density.count));
+
+		add_warp_calculator_cases(runner, warps.back(), warp_density.name);
+		add_warp_calculator_check(runner, warps.back(), warp_density.name);
+	}
+
+	for (const auto& density : ENVELOPE_DENSITIES)
+	{
+		const auto pitch = make_envelope(EnvelopeKind::Pitch, density.count);
+		const auto speed = make_envelope(EnvelopeKind::Speed, density.count);
+
+		add_calculator_cases(runner, pitch, speed, density.name);
+
+		for (std::size_t s = 0; s < std::size(SCENARIOS); s++)
+		{
+			add_classic_cases(runner, pitch, density.name, SCENARIOS[s], positions[s]);
+
+			for (std::size_t w = 0; w < std::size(WARP_DENSITIES); w++)
+			{
+				add_fudge_cases(runner, speed, warps[w], density.name, WARP_DENSITIES[w].name, SCENARIOS[s], positions[s]);
+			}
+		}
+
+		add_precision_checks(runner, pitch, speed, density.name);
+
+		for (std::size_t w = 0; w < std::size(WARP_DENSITIES); w++)
+		{
+			add_warp_precision_checks(runner, speed, warps[w], density.name, WARP_DENSITIES[w].name);
+		}
+	}
+}
+
+}}
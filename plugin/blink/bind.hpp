@@ -423,6 +423,12 @@ inline blink_SamplerInstance sampler_instance(SamplerInstance* instance)
 	return out;
 }
 
+// For implementing blink_sampler_process_vectors()
+inline blink_Error sampler_process_vectors(void* unit_proc_data, const blink_SamplerBuffer* buffer, blink_Index num_vectors, float* out)
+{
+	return ((SamplerUnit*)(unit_proc_data))->sampler_process_vectors(buffer, num_vectors, out);
+}
+
 #endif
 
 #ifdef BLINK_EFFECT
@@ -464,6 +470,18 @@ inline blink_EffectInstance effect_instance(EffectInstance* instance)
 
 	return out;
 }
+
+// For implementing blink_effect_process_vectors()
+inline blink_Error effect_process_vectors(void* unit_proc_data, const blink_EffectBuffer* buffer, blink_Index num_vectors, const float* in, float* out)
+{
+	return ((EffectUnit*)(unit_proc_data))->effect_process_vectors(buffer, num_vectors, in, out);
+}
+
+// For implementing blink_effect_get_unit_flags()
+inline int effect_unit_flags(void* unit_proc_data)
+{
+	return ((EffectUnit*)(unit_proc_data))->get_flags();
+}
 #endif
 
 #ifdef BLINK_SYNTH
@@ -498,6 +516,70 @@ inline blink_SynthInstance synth_instance(SynthInstance* instance)
 
 	return out;
 }
+
+// For implementing blink_synth_process_vectors()
+inline blink_Error synth_process_vectors(void* unit_proc_data, const blink_SynthBuffer* buffer, blink_Index num_vectors, float* out)
+{
+	return ((SynthUnit*)(unit_proc_data))->synth_process_vectors(buffer, num_vectors, out);
+}
 #endif
 
+//
+// For implementing blink_get_output_state(). [UnitType] is the type the
+// unit's proc_data was bound with (SamplerUnit, EffectUnit or SynthUnit)
+//
+template <class UnitType>
+inline blink_OutputState output_state(void* unit_proc_data)
+{
+	return ((UnitType*)(unit_proc_data))->get_output_state();
+}
+
+//
+// For implementing blink_activate_unit() and blink_deactivate_unit()
+//
+template <class UnitType>
+inline blink_Error activate_unit(void* unit_proc_data)
+{
+	((UnitType*)(unit_proc_data))->activate();
+
+	return BLINK_OK;
+}
+
+template <class UnitType>
+inline blink_Error deactivate_unit(void* unit_proc_data)
+{
+	((UnitType*)(unit_proc_data))->deactivate();
+
+	return BLINK_OK;
+}
+
+//
+// For implementing blink_set_parameter_generations()
+//
+template <class UnitType>
+inline blink_Error set_parameter_generations(void* unit_proc_data, const std::uint64_t* generations)
+{
+	((UnitType*)(unit_proc_data))->set_parameter_generations(generations);
+
+	return BLINK_OK;
+}
+
+//
+// For implementing blink_get_profile_stats(). [UnitType] is the type the
+// unit's proc_data was bound with (SamplerUnit, EffectUnit or SynthUnit)
+//
+template <class UnitType>
+inline blink_Error profile_stats(void* unit_proc_data, blink_ProfileStats* out)
+{
+#ifdef BLINK_PROFILE
+	((UnitType*)(unit_proc_data))->get_profile_stats(out);
+
+	return BLINK_OK;
+#else
+	*out = blink_ProfileStats();
+
+	return blink_StdError_NotImplemented;
+#endif
+}
+
 }}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace blink {
 namespace bits {
 
@@ -9,4 +15,30 @@ inline bool check(T mask, T bit)
 	return (mask >> bit) & 1U;
 }
 
-}}
\ No newline at end of file
+// Index of the lowest set bit, or 64 if [mask] is zero
+inline int find_first_set(std::uint64_t mask)
+{
+	if (mask == 0) return 64;
+
+#if defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward64(&index, mask);
+
+	return int(index);
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// Number of set bits in [mask]
+inline int count_set_bits(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+	return int(__popcnt64(mask));
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+}}
@@ -2,6 +2,7 @@
 
 #include <limits>
 #include <snd/transport/frame_position.hpp>
+#include "fixed_position.hpp"
 
 #pragma warning(push, 0)
 #include <DSP/MLDSPOps.h>
@@ -9,22 +10,30 @@
 
 namespace blink {
 
+//
+// [fixed_positions] is exact and is the only thing filled in when the block
+// positions change. The snd positions are converted from it the first time
+// something asks for them, so code which only reads [fixed_positions] (the
+// standard traversers and parameter searches) never pays for them
+//
 struct BlockPositions
 {
-	snd::transport::DSPVectorFramePosition positions;
-	snd::transport::FramePosition prev_pos = std::numeric_limits<std::int32_t>::max();
+	FixedPositionVector fixed_positions;
+	FixedPosition fixed_prev_pos = FixedPosition::from_frame(std::numeric_limits<std::int32_t>::max());
 
 	int count = kFloatsPerDSPVector;
 	std::int64_t data_offset = 0;
 
 	BlockPositions()
 	{
-		positions.set(count - 1, std::numeric_limits<std::int32_t>::max());
+		fixed_positions.set(count - 1, FixedPosition::from_frame(std::numeric_limits<std::int32_t>::max()));
 	}
 
 	BlockPositions(const snd::transport::DSPVectorFramePosition& positions_, snd::transport::FramePosition prev_pos_ = std::numeric_limits<std::int32_t>::max())
-		: positions(positions_)
-		, prev_pos(prev_pos_)
+		: fixed_positions(positions_)
+		, fixed_prev_pos(FixedPosition::from_frame_position(prev_pos_))
+		, positions_(positions_)
+		, positions_ready_(true)
 	{
 	}
 
@@ -34,32 +43,71 @@ struct BlockPositions
 	{
 		for (int i = 0; i < count_; i++)
 		{
-			positions.set(i, blink_positions[i] - offset);
+			fixed_positions.set(i, blink_positions[i] - offset);
 		}
 	}
 
 	void operator()(const blink_Position* blink_positions, std::int64_t offset, int count_)
 	{
-		prev_pos = positions[count - 1];
+		fixed_prev_pos = fixed_positions[count - 1];
 
 		for (int i = 0; i < count_; i++)
 		{
-			positions.set(i, blink_positions[i] - offset);
+			fixed_positions.set(i, blink_positions[i] - offset);
 		}
-		
+
 		count = count_;
 		data_offset = offset;
+		positions_ready_ = false;
 	}
 
 	void operator()(const snd::transport::DSPVectorFramePosition& vec_positions, std::int64_t offset, int count_)
 	{
-		prev_pos = positions[count - 1];
+		fixed_prev_pos = fixed_positions[count - 1];
+		fixed_positions = FixedPositionVector(vec_positions) - offset;
+
+		count = count_;
+		data_offset = offset;
+		positions_ready_ = false;
+	}
 
-		positions = vec_positions - std::int32_t(offset);
+	void operator()(const FixedPositionVector& vec_positions, std::int64_t offset, int count_)
+	{
+		fixed_prev_pos = fixed_positions[count - 1];
+		fixed_positions = vec_positions - offset;
 
 		count = count_;
 		data_offset = offset;
+		positions_ready_ = false;
 	}
+
+	// [fixed_positions] as snd frame positions
+	const snd::transport::DSPVectorFramePosition& positions() const
+	{
+		if (!positions_ready_)
+		{
+			positions_ = fixed_positions.to_frame_positions();
+			positions_ready_ = true;
+		}
+
+		return positions_;
+	}
+
+	// [fixed_prev_pos] as an snd frame position
+	snd::transport::FramePosition prev_pos() const
+	{
+		snd::transport::FramePosition out;
+
+		out.pos = std::int32_t(fixed_prev_pos.frame());
+		out.fract = fixed_prev_pos.fract();
+
+		return out;
+	}
+
+private:
+
+	mutable snd::transport::DSPVectorFramePosition positions_;
+	mutable bool positions_ready_ = false;
 };
 
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 #include "parameter.hpp"
 #include "chord_spec.hpp"
 #include "block_positions.hpp"
+#include "profile.hpp"
 
 #pragma warning(push, 0)
 #include <DSP/MLDSPOps.h>
@@ -51,13 +52,15 @@ inline void ChordParameter::search_vec(const blink_ChordData* data, const BlockP
 
 inline void ChordParameter::search_vec(const blink_ChordData* data, const BlockPositions& block_positions, int n, int* out) const
 {
+	profile::EnvelopeScope profile_scope;
+
 	int left = 0;
 	bool reset = false;
-	auto prev_pos = block_positions.prev_pos;
+	auto prev_pos = block_positions.fixed_prev_pos;
 
 	for (int i = 0; i < n; i++)
 	{
-		const auto pos = block_positions.positions[i];
+		const auto pos = block_positions.fixed_positions[i];
 
 		if (pos < prev_pos)
 		{
@@ -70,11 +73,13 @@ inline void ChordParameter::search_vec(const blink_ChordData* data, const BlockP
 		{
 			reset = false;
 
-			out[i] = spec_.search_binary(data, block_positions.positions[i], 0, &left);
+			profile::count_binary_search();
+
+			out[i] = spec_.search_binary(data, blink_Position(pos), 0, &left);
 		}
 		else
 		{
-			out[i] = spec_.search_forward(data, block_positions.positions[i], left, &left);
+			out[i] = spec_.search_forward(data, blink_Position(pos), left, &left);
 		}
 
 		prev_pos = pos;
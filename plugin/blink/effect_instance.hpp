@@ -16,7 +16,7 @@ public:
 	virtual ~EffectInstance();
 
 	virtual blink_EffectInstanceInfo get_info() const;
-	
+
 	EffectUnit* add_unit();
 
 private:
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <set>
 #include <blink/plugin.hpp>
 #include <blink/effect_instance.hpp>
 
@@ -19,14 +18,13 @@ private:
 
 	virtual EffectInstance* make_instance() = 0;
 
-	std::set<EffectInstance*> instances_;
 };
 
 inline EffectPlugin::~EffectPlugin()
 {
-	for (auto instance : instances_)
+	while (const auto instance = first_instance())
 	{
-		delete instance;
+		destroy_instance(static_cast<EffectInstance*>(instance));
 	}
 }
 
@@ -34,7 +32,6 @@ inline EffectInstance* EffectPlugin::add_instance()
 {
 	const auto instance = make_instance();
 
-	instances_.insert(instance);
 	register_instance(instance);
 
 	return instance;
@@ -42,7 +39,6 @@ inline EffectInstance* EffectPlugin::add_instance()
 
 inline void EffectPlugin::destroy_instance(EffectInstance* instance)
 {
-	instances_.erase(instance);
 	unregister_instance(instance);
 	delete instance;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <blink_effect.h>
 #include "envelope_spec.hpp"
@@ -8,6 +9,7 @@
 #include "slider_spec.hpp"
 #include "unit.hpp"
 #include "instance.hpp"
+#include "plugin.hpp"
 
 namespace blink {
 
@@ -23,13 +25,99 @@ public:
 
 	virtual ~EffectUnit() {}
 
+	//
+	// [in] and [out] may point to the same buffer. Unless the unit has
+	// declared itself safe for that (see set_in_place_safe()) the input is
+	// copied first so that process() never sees them aliased
+	//
 	blink_Error effect_process(const blink_EffectBuffer* buffer, const float* in, float* out)
 	{
+		if (!is_active()) return blink_StdError_UnitInactive;
+
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("effect_process", this, buffer->buffer_id);
+
 		get_instance()->begin_process(buffer->buffer_id);
 
 		Unit::begin_process(buffer->buffer_id, buffer->positions, buffer->data_offset);
 
-		return process(buffer, in, out);
+		update_parameter_changes();
+
+		begin_vector();
+
+		const auto result = process(buffer, unalias(in, out), out);
+
+		end_vector(out, 0);
+
+		return result;
+	}
+
+	//
+	// For implementing blink_effect_process_batch(). Units are processed back to
+	// back without going through the function pointers
+	//
+	static blink_Error process_batch(blink_EffectJob* jobs, blink_Index count)
+	{
+		blink_Error out = BLINK_OK;
+
+		for (blink_Index i = 0; i < count; i++)
+		{
+			auto& job = jobs[i];
+			auto unit = (EffectUnit*)(job.proc_data);
+
+			job.result = unit->effect_process(job.buffer, job.in, job.out);
+
+			if (job.result != BLINK_OK && out == BLINK_OK)
+			{
+				out = job.result;
+			}
+		}
+
+		return out;
+	}
+
+	blink_Error effect_process_vectors(const blink_EffectBuffer* buffer, blink_Index num_vectors, const float* in, float* out)
+	{
+		if (num_vectors < 1) return blink_StdError_InvalidArgument;
+		if (!is_active()) return blink_StdError_UnitInactive;
+
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("effect_process_vectors", this, buffer->buffer_id);
+
+		get_instance()->begin_process(buffer->buffer_id, int(num_vectors));
+
+		Unit::begin_process(buffer->buffer_id, int(num_vectors));
+
+		auto vector_buffer = *buffer;
+
+		for (blink_Index i = 0; i < num_vectors; i++)
+		{
+			const auto offset = i * BLINK_VECTOR_SIZE * 2;
+
+			vector_buffer.buffer_id = buffer->buffer_id + i;
+			vector_buffer.positions = buffer->positions + (i * BLINK_VECTOR_SIZE);
+
+			Unit::set_positions(vector_buffer.positions, buffer->data_offset);
+
+			update_parameter_changes();
+
+			begin_vector();
+
+			const auto result = process(&vector_buffer, unalias(in + offset, out + offset), out + offset);
+
+			end_vector(out + offset, int(i));
+
+			if (result != BLINK_OK) return result;
+		}
+
+		return BLINK_OK;
+	}
+
+	// blink_EffectUnitFlags, for blink_effect_get_unit_flags(). The in-place
+	// flag tells the host that processing in place costs nothing extra
+	int get_flags() const
+	{
+		return in_place_safe_ ? blink_EffectUnitFlags_InPlace : blink_EffectUnitFlags_None;
 	}
 
 	// Called by UI thread
@@ -47,9 +135,34 @@ public:
 		return out;
 	}
 
+protected:
+
+	//
+	// Units whose process() reads all of its input before writing any
+	// output (e.g. by loading [in] into a DSPVectorArray first) can call
+	// this to skip the copy of the input when the host processes them in
+	// place. Call it from the constructor, since the host asks for the
+	// unit's flags straight after adding it
+	//
+	void set_in_place_safe(bool safe) { in_place_safe_ = safe; }
+
 private:
 
 	virtual blink_Error process(const blink_EffectBuffer* buffer, const float* in, float* out) = 0;
+
+	// The input to pass to process(). If the unit isn't in-place safe and
+	// [in] is also the output, a copy of one vector of it
+	const float* unalias(const float* in, const float* out)
+	{
+		if (in != out || in_place_safe_) return in;
+
+		std::copy(in, in + (kFloatsPerDSPVector * 2), in_copy_.getBuffer());
+
+		return in_copy_.getConstBuffer();
+	}
+
+	bool in_place_safe_ = false;
+	ml::DSPVectorArray<2> in_copy_;
 };
 
 }
\ No newline at end of file
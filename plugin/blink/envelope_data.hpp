@@ -23,7 +23,7 @@ public:
 
 	float search(const BlockPositions& block_positions) const
 	{
-		return search(block_positions.positions[0]);
+		return search(blink_Position(block_positions.fixed_positions[0]));
 	}
 
 	void search_vec(const BlockPositions& block_positions, int n, float* out) const
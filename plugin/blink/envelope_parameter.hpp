@@ -6,6 +6,7 @@
 #include "envelope_snap_settings.hpp"
 #include "parameter.hpp"
 #include "option_parameter.hpp"
+#include "profile.hpp"
 #include "traverser.hpp"
 #include "math.hpp"
 
@@ -73,6 +74,9 @@ inline std::optional<float> EnvelopeParameter::get_stepline(int index, float ste
 
 inline float EnvelopeParameter::search(const blink_EnvelopeData* data, blink_Position block_position) const
 {
+	profile::EnvelopeScope profile_scope;
+	profile::count_binary_search();
+
 	int left;
 
 	return spec_.search_binary(data, spec_.default_value, block_position, 0, &left);
@@ -85,13 +89,15 @@ inline void EnvelopeParameter::search_vec(const blink_EnvelopeData* data, const
 
 inline void EnvelopeParameter::search_vec(const blink_EnvelopeData* data, const BlockPositions& block_positions, int n, float* out) const
 {
+	profile::EnvelopeScope profile_scope;
+
 	int left = 0;
 	bool reset = false;
-	auto prev_pos = block_positions.prev_pos;
+	auto prev_pos = block_positions.fixed_prev_pos;
 
 	for (int i = 0; i < n; i++)
 	{
-		const auto pos = block_positions.positions[i];
+		const auto pos = block_positions.fixed_positions[i];
 
 		if (pos < prev_pos)
 		{
@@ -104,11 +110,13 @@ inline void EnvelopeParameter::search_vec(const blink_EnvelopeData* data, const
 		{
 			reset = false;
 
-			out[i] = spec_.search_binary(data, spec_.default_value, block_positions.positions[i], 0, &left);
+			profile::count_binary_search();
+
+			out[i] = spec_.search_binary(data, spec_.default_value, blink_Position(pos), 0, &left);
 		}
 		else
 		{
-			out[i] = spec_.search_forward(data, spec_.default_value, block_positions.positions[i], left, &left);
+			out[i] = spec_.search_forward(data, spec_.default_value, blink_Position(pos), left, &left);
 		}
 
 		prev_pos = pos;
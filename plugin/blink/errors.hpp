@@ -11,6 +11,9 @@ inline const char* get_std_error_string(blink_StdError error)
 		case blink_StdError_AlreadyInitialized: return "already initialized";
 		case blink_StdError_NotInitialized: return "not initialized";
 		case blink_StdError_NotImplemented: return "not implemented";
+		case blink_StdError_FileError: return "file error";
+		case blink_StdError_InvalidArgument: return "invalid argument";
+		case blink_StdError_UnitInactive: return "unit is inactive";
 		default: return "unknown error";
 	}
 }
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <blink.h>
+#include <snd/transport/frame_position.hpp>
+
+#pragma warning(push, 0)
+#include <DSP/MLDSPOps.h>
+#pragma warning(pop)
+
+namespace blink {
+
+namespace fixed_position_detail {
+
+// Rounds [x] to the nearest integer, saturating instead of overflowing for
+// positions too far out to represent (e.g. sentinel values, or very long
+// songs at a high frequency factor). NaN becomes zero
+inline std::int64_t round_saturate(double x)
+{
+	// The largest double below 2^63
+	constexpr double MAX = 9223372036854774784.0;
+
+	if (x >= MAX) return std::numeric_limits<std::int64_t>::max();
+	if (x <= -MAX) return std::numeric_limits<std::int64_t>::min();
+	if (!(x == x)) return 0;
+
+	return std::llround(x);
+}
+
+inline std::int64_t add_saturate(std::int64_t a, std::int64_t b)
+{
+	if (b > 0 && a > std::numeric_limits<std::int64_t>::max() - b) return std::numeric_limits<std::int64_t>::max();
+	if (b < 0 && a < std::numeric_limits<std::int64_t>::min() - b) return std::numeric_limits<std::int64_t>::min();
+
+	return a + b;
+}
+
+// The top 24 bits of the fraction, which is all a float can hold. Using
+// the full 32 bits would round up to 1.0f right below the next frame
+inline float fract_to_float(std::int64_t value)
+{
+	return float(std::uint32_t((value & ((std::int64_t(1) << 32) - 1)) >> 8)) * (1.0f / float(1 << 24));
+}
+
+}
+
+//
+// 64-bit fixed point frame position. The upper 32 bits are the frame index
+// and the lower 32 bits are the fraction.
+//
+// Unlike a float this stays exact for hour long samples, and splitting a
+// position into its frame index and fraction is just a shift and a mask.
+//
+struct FixedPosition
+{
+	static constexpr int FRACT_BITS = 32;
+	static constexpr std::int64_t ONE = std::int64_t(1) << FRACT_BITS;
+	static constexpr std::int64_t FRACT_MASK = ONE - 1;
+
+	std::int64_t value = 0;
+
+	FixedPosition() = default;
+
+	explicit FixedPosition(blink_Position position)
+		: value(fixed_position_detail::round_saturate(position * double(ONE)))
+	{
+	}
+
+	static FixedPosition from_frame(std::int64_t frame)
+	{
+		FixedPosition out;
+
+		out.value = frame << FRACT_BITS;
+
+		return out;
+	}
+
+	static FixedPosition from_frame_position(const snd::transport::FramePosition& position)
+	{
+		return from_raw((std::int64_t(position.pos) << FRACT_BITS) + std::int64_t(double(position.fract) * double(ONE)));
+	}
+
+	static FixedPosition from_raw(std::int64_t value)
+	{
+		FixedPosition out;
+
+		out.value = value;
+
+		return out;
+	}
+
+	std::int64_t frame() const { return value >> FRACT_BITS; }
+	float fract() const { return fixed_position_detail::fract_to_float(value); }
+
+	operator blink_Position() const
+	{
+		return double(frame()) + (double(value & FRACT_MASK) * (1.0 / double(ONE)));
+	}
+
+	bool operator<(const FixedPosition& rhs) const { return value < rhs.value; }
+	bool operator>(const FixedPosition& rhs) const { return value > rhs.value; }
+	bool operator<=(const FixedPosition& rhs) const { return value <= rhs.value; }
+	bool operator>=(const FixedPosition& rhs) const { return value >= rhs.value; }
+	bool operator==(const FixedPosition& rhs) const { return value == rhs.value; }
+	bool operator!=(const FixedPosition& rhs) const { return value != rhs.value; }
+};
+
+//
+// A DSP vector of fixed point positions. The arithmetic is plain loops over
+// 64-bit integers which the compiler is able to vectorize
+//
+struct alignas(16) FixedPositionVector
+{
+	std::int64_t values[kFloatsPerDSPVector];
+
+	FixedPositionVector()
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++) values[i] = 0;
+	}
+
+	explicit FixedPositionVector(FixedPosition position)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++) values[i] = position.value;
+	}
+
+	explicit FixedPositionVector(const snd::transport::DSPVectorFramePosition& positions)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			values[i] = FixedPosition::from_frame_position(positions[i]).value;
+		}
+	}
+
+	FixedPosition operator[](int index) const { return FixedPosition::from_raw(values[index]); }
+
+	void set(int index, FixedPosition position) { values[index] = position.value; }
+	void set(int index, blink_Position position) { values[index] = FixedPosition(position).value; }
+
+	// Frame indices (rounded down)
+	ml::DSPVectorInt frames() const
+	{
+		ml::DSPVectorInt out;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			out[i] = std::int32_t(values[i] >> FixedPosition::FRACT_BITS);
+		}
+
+		return out;
+	}
+
+	// Fractional parts in the range [0..1)
+	ml::DSPVector fract() const
+	{
+		ml::DSPVector out;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			out[i] = fixed_position_detail::fract_to_float(values[i]);
+		}
+
+		return out;
+	}
+
+	snd::transport::DSPVectorFramePosition to_frame_positions() const
+	{
+		snd::transport::DSPVectorFramePosition out;
+
+		const auto frames_vec = frames();
+		const auto fract_vec = fract();
+
+		out.pos = frames_vec;
+		out.fract = fract_vec;
+
+		return out;
+	}
+
+	FixedPositionVector& operator+=(std::int64_t frames)
+	{
+		const auto offset = frames << FixedPosition::FRACT_BITS;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) values[i] += offset;
+
+		return *this;
+	}
+
+	FixedPositionVector& operator-=(std::int64_t frames)
+	{
+		const auto offset = frames << FixedPosition::FRACT_BITS;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++) values[i] -= offset;
+
+		return *this;
+	}
+
+	FixedPositionVector operator+(std::int64_t frames) const
+	{
+		auto out = *this;
+
+		out += frames;
+
+		return out;
+	}
+
+	FixedPositionVector operator-(std::int64_t frames) const
+	{
+		auto out = *this;
+
+		out -= frames;
+
+		return out;
+	}
+
+	// The integer and fractional parts are scaled separately so that no
+	// precision is lost for large positions. Results which don't fit
+	// saturate
+	FixedPositionVector operator*(double x) const
+	{
+		FixedPositionVector out;
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			const auto frame = double(values[i] >> FixedPosition::FRACT_BITS);
+			const auto fract = double(values[i] & FixedPosition::FRACT_MASK);
+
+			out.values[i] = fixed_position_detail::add_saturate(
+				fixed_position_detail::round_saturate(frame * x * double(FixedPosition::ONE)),
+				fixed_position_detail::round_saturate(fract * x));
+		}
+
+		return out;
+	}
+};
+
+}
@@ -1,12 +1,26 @@
 #pragma once
 
-#include <set>
+#include <atomic>
+#include <thread>
+#include "arena.hpp"
+#include "intrusive_list.hpp"
 #include "unit.hpp"
 
 namespace blink {
 
 class Plugin;
 
+extern Arena& get_arena(Plugin*);
+
+//
+// The units of an instance may be processed concurrently on different
+// threads. The instance's bookkeeping is lock-free and reset() is called by
+// exactly one of the units at the start of a buffer, with the others
+// waiting for it to finish before they go on to process.
+//
+// Apart from during reset(), instance state should be treated as read-only
+// while units are processing.
+//
 class Instance
 {
 public:
@@ -15,7 +29,23 @@ public:
 
 	virtual ~Instance() {}
 
-	void begin_process(std::uint64_t buffer_id);
+	//
+	// Allocate instances from the plugin's arena in make_instance() with
+	//
+	//	new (get_arena()) MyInstance(this)
+	//
+	// Instances created with a plain new come from the heap. Either way they
+	// are freed with a plain delete
+	//
+	static void* operator new(std::size_t size) { return Arena::allocate_tagged(nullptr, size); }
+	static void* operator new(std::size_t size, Arena& arena) { return Arena::allocate_tagged(&arena, size); }
+	static void operator delete(void* ptr, std::size_t size) { Arena::deallocate_tagged(ptr, size); }
+
+	// Only called if a constructor throws. Without the size the memory is
+	// only reused for smaller objects
+	static void operator delete(void* ptr, Arena&) { Arena::deallocate_tagged(ptr, 0); }
+
+	void begin_process(std::uint64_t buffer_id, int num_vectors = 1);
 	void stream_init(blink_SR SR);
 
 	Plugin* get_plugin() const { return plugin_; }
@@ -23,19 +53,47 @@ public:
 
 protected:
 
+	//
+	// Use this in make_unit() so that the unit and its control block come
+	// from the plugin's arena, next to the instance, e.g.
+	//
+	//	return make_arena_unit<MyUnit>(this);
+	//
+	template <class T, class... Args>
+	std::shared_ptr<T> make_arena_unit(Args&&... args)
+	{
+		return make_arena_shared<T>(get_arena(plugin_), std::forward<Args>(args)...);
+	}
+
 	void register_unit(Unit* unit);
 	void unregister_unit(Unit* unit);
 
 private:
 
+	friend class Plugin;
+
 	virtual void reset() {}
 	virtual void stream_init() {}
 
 	Plugin* plugin_;
 	blink_SR SR_;
-	std::set<Unit*> units_;
-	std::uint64_t buffer_id_ = 0;
-	int active_buffer_units_ = 0;
+	IntrusiveList<Unit, &Unit::instance_hook_> units_;
+	IntrusiveListHook<Instance> plugin_hook_;
+
+	//
+	// The most recent buffer which a unit has started processing, in the
+	// upper bits, and how many units have started processing it, in the
+	// lower UNIT_BITS. Keeping them in one word means a unit which is late
+	// for a buffer can't add itself to the count of the next one
+	//
+	static constexpr int UNIT_BITS = 16;
+	static constexpr std::uint64_t UNIT_MASK = (std::uint64_t(1) << UNIT_BITS) - 1;
+
+	std::atomic<std::uint64_t> buffer_state_ { 0 };
+
+	// The most recent buffer which is ready to be processed, i.e. reset()
+	// has been called if it needed to be
+	std::atomic<std::uint64_t> ready_buffer_id_ { 0 };
 };
 
 inline blink_SR get_SR(Instance* instance)
@@ -60,34 +118,81 @@ inline void Instance::stream_init(blink_SR SR)
 	}
 }
 
-inline void Instance::begin_process(std::uint64_t buffer_id)
+inline void Instance::begin_process(std::uint64_t buffer_id, int num_vectors)
 {
 	//
 	// Instance::reset() is called at the start of the buffer if we have gone
 	// at least one buffer with no units being processed
 	//
-	if (buffer_id > buffer_id_)
+	// When several vectors are processed in one go, [buffer_id] is the ID of
+	// the first one
+	//
+	const auto last_buffer_id = buffer_id + num_vectors - 1;
+
+	auto state = buffer_state_.load(std::memory_order_acquire);
+
+	for (;;)
 	{
-		if (buffer_id > buffer_id_ + 1 || active_buffer_units_ == 0)
+		const auto current = state >> UNIT_BITS;
+		const auto num_units = state & UNIT_MASK;
+
+		if (buffer_id > current)
 		{
-			reset();
+			//
+			// The first unit to get here for this buffer is elected to do the
+			// reset
+			//
+			const auto next = (last_buffer_id << UNIT_BITS) | 1;
+
+			if (!buffer_state_.compare_exchange_weak(state, next, std::memory_order_acq_rel)) continue;
+
+			if (buffer_id > current + 1 || num_units == 0)
+			{
+				trace::Scope trace_scope("Instance::reset", this, buffer_id);
+
+				reset();
+			}
+
+			//
+			// Never moves backwards, in case a unit for a later buffer was
+			// elected and finished first
+			//
+			auto ready = ready_buffer_id_.load(std::memory_order_relaxed);
+
+			while (ready < last_buffer_id && !ready_buffer_id_.compare_exchange_weak(ready, last_buffer_id, std::memory_order_release, std::memory_order_relaxed)) {}
+
+			return;
 		}
 
-		buffer_id_ = buffer_id;
-		active_buffer_units_ = 0;
+		//
+		// A unit which is still processing an older buffer doesn't count
+		// towards the current one
+		//
+		if (last_buffer_id < current) return;
+		if (num_units == UNIT_MASK) break;
+		if (buffer_state_.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel)) break;
 	}
 
-	active_buffer_units_++;
+	//
+	// Everyone else waits for the elected unit to finish the reset for the
+	// buffer they joined. This is almost never more than a few iterations
+	//
+	const auto joined_buffer_id = state >> UNIT_BITS;
+
+	for (int spins = 0; ready_buffer_id_.load(std::memory_order_acquire) < joined_buffer_id; spins++)
+	{
+		if (spins > 64) std::this_thread::yield();
+	}
 }
 
 inline void Instance::register_unit(Unit* unit)
 {
-	units_.insert(unit);
+	units_.push_back(unit);
 }
 
 inline void Instance::unregister_unit(Unit* unit)
 {
-	units_.erase(unit);
+	units_.remove(unit);
 }
 
 } // blink
\ No newline at end of file
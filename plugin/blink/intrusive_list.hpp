@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+
+namespace blink {
+
+template <class T>
+struct IntrusiveListHook
+{
+	T* prev = nullptr;
+	T* next = nullptr;
+	bool linked = false;
+};
+
+//
+// A doubly linked list threaded through the elements themselves via the
+// hook member [HOOK], so adding and removing never allocates. The list does
+// not own its elements
+//
+template <class T, IntrusiveListHook<T> T::*HOOK>
+class IntrusiveList
+{
+public:
+
+	class Iterator
+	{
+	public:
+
+		Iterator(T* item) : item_(item) {}
+
+		T* operator*() const { return item_; }
+		Iterator& operator++() { item_ = (item_->*HOOK).next; return *this; }
+		bool operator!=(const Iterator& rhs) const { return item_ != rhs.item_; }
+		bool operator==(const Iterator& rhs) const { return item_ == rhs.item_; }
+
+	private:
+
+		T* item_;
+	};
+
+	void push_back(T* item);
+	void remove(T* item);
+
+	T* front() const { return head_; }
+	bool empty() const { return head_ == nullptr; }
+	std::size_t size() const { return size_; }
+
+	Iterator begin() const { return Iterator(head_); }
+	Iterator end() const { return Iterator(nullptr); }
+
+private:
+
+	T* head_ = nullptr;
+	T* tail_ = nullptr;
+	std::size_t size_ = 0;
+};
+
+template <class T, IntrusiveListHook<T> T::*HOOK>
+inline void IntrusiveList<T, HOOK>::push_back(T* item)
+{
+	auto& hook = item->*HOOK;
+
+	if (hook.linked) return;
+
+	hook.prev = tail_;
+	hook.next = nullptr;
+	hook.linked = true;
+
+	if (tail_) (tail_->*HOOK).next = item;
+	else head_ = item;
+
+	tail_ = item;
+	size_++;
+}
+
+template <class T, IntrusiveListHook<T> T::*HOOK>
+inline void IntrusiveList<T, HOOK>::remove(T* item)
+{
+	auto& hook = item->*HOOK;
+
+	if (!hook.linked) return;
+
+	if (hook.prev) (hook.prev->*HOOK).next = hook.next;
+	else head_ = hook.next;
+
+	if (hook.next) (hook.next->*HOOK).prev = hook.prev;
+	else tail_ = hook.prev;
+
+	hook.prev = nullptr;
+	hook.next = nullptr;
+	hook.linked = false;
+	size_--;
+}
+
+}
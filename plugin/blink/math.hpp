@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include <snd/transport/frame_position.hpp>
+#include "fixed_position.hpp"
 
 #pragma warning(push, 0)
 #include <DSP/MLDSPOps.h>
@@ -233,6 +234,36 @@ ml::DSPVectorArrayInt<ROWS> floor(const snd::transport::DSPVectorArrayFramePosit
 	return in.pos;
 }
 
+// Positions are left alone when there is nothing to wrap around (an empty
+// sample)
+inline FixedPositionVector wrap(const FixedPositionVector& x, std::int64_t frames)
+{
+	if (frames <= 0) return x;
+
+	FixedPositionVector out;
+
+	const auto y = frames << FixedPosition::FRACT_BITS;
+
+	for (int i = 0; i < kFloatsPerDSPVector; i++)
+	{
+		out.values[i] = x.values[i] % y;
+
+		if (out.values[i] < 0) out.values[i] += y;
+	}
+
+	return out;
+}
+
+inline ml::DSPVectorInt ceil(const FixedPositionVector& in)
+{
+	return (in + 1).frames();
+}
+
+inline ml::DSPVectorInt floor(const FixedPositionVector& in)
+{
+	return in.frames();
+}
+
 template <size_t ROWS>
 ml::DSPVectorArray<ROWS> wrap(const ml::DSPVectorArray<ROWS>& x, float y)
 {
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace blink {
+
+//
+// Turns the per-parameter generation counters passed in by the host into
+// dirty flags, so that derived state (filter coefficients, envelope caches
+// etc.) only has to be recalculated when the parameter actually changed.
+//
+// Everything is dirty the first time, and always dirty if the host doesn't
+// pass in generation counters.
+//
+// Sized up front when the unit is created so that update(), which runs on
+// the audio thread, never allocates.
+//
+class ParameterChanges
+{
+public:
+
+	ParameterChanges(int num_parameters);
+
+	// [generations] is an array of one counter per parameter, or null
+	void update(const std::uint64_t* generations);
+
+	bool any_dirty() const { return any_dirty_; }
+	bool is_dirty(int index) const { return dirty_[index] != 0; }
+
+	// Forces everything to be dirty next time
+	void invalidate() { have_generations_ = false; }
+
+private:
+
+	std::vector<std::uint64_t> generations_;
+	std::vector<std::uint8_t> dirty_;
+	bool any_dirty_ = true;
+	bool have_generations_ = false;
+};
+
+inline ParameterChanges::ParameterChanges(int num_parameters)
+	: generations_(num_parameters, 0)
+	, dirty_(num_parameters, 1)
+{
+}
+
+inline void ParameterChanges::update(const std::uint64_t* generations)
+{
+	const auto num_parameters = int(generations_.size());
+
+	if (!generations || !have_generations_)
+	{
+		std::fill(dirty_.begin(), dirty_.end(), std::uint8_t(1));
+
+		any_dirty_ = true;
+		have_generations_ = generations != nullptr;
+
+		if (generations)
+		{
+			std::copy(generations, generations + num_parameters, generations_.begin());
+		}
+
+		return;
+	}
+
+	std::uint8_t any_dirty = 0;
+
+	for (int i = 0; i < num_parameters; i++)
+	{
+		const auto dirty = std::uint8_t(generations[i] != generations_[i]);
+
+		dirty_[i] = dirty;
+		any_dirty |= dirty;
+		generations_[i] = generations[i];
+	}
+
+	any_dirty_ = any_dirty != 0;
+}
+
+}
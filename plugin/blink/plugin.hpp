@@ -1,9 +1,7 @@
 #pragma once
 
 #define _USE_MATH_DEFINES
-#include <map>
 #include <memory>
-#include <set>
 #include "blink.h"
 #include "instance.hpp"
 #include "envelope_spec.hpp"
@@ -14,6 +12,7 @@
 #include "option_parameter.hpp"
 #include "slider_parameter.hpp"
 #include "toggle_parameter.hpp"
+#include "uuid.hpp"
 
 namespace blink {
 
@@ -24,8 +23,14 @@ public:
 	void register_instance(Instance* instance);
 	void unregister_instance(Instance* instance);
 
+	// The first registered instance, or null
+	Instance* first_instance() const { return instances_.front(); }
+
 	void stream_init(blink_SR SR);
 
+	// Instances and units are allocated from this. See Instance
+	Arena& get_arena() { return arena_; }
+
 	int get_num_groups() const;
 	int get_num_parameters() const;
 
@@ -40,8 +45,14 @@ public:
 
 	const Group& get_group(int index) const;
 	Parameter& get_parameter(blink_Index index);
+
+	// [uuid] is compared by value so it doesn't have to be the same pointer
+	// the parameter was added with. The parameter must exist
 	Parameter& get_parameter_by_uuid(blink_UUID uuid);
 
+	// Returns null if there is no parameter with this UUID
+	Parameter* find_parameter_by_uuid(blink_UUID uuid) const;
+
 	template <int Index> static const blink_EnvelopeData* get_envelope_data(const blink_ParameterData* data);
 	template <int Index> static const blink_ToggleData* get_toggle_data(const blink_ParameterData* data);
 	template <int Index, bool Default = false> static bool get_toggle_value(const blink_ParameterData* data);
@@ -57,11 +68,14 @@ private:
 
 	void add_parameter(blink_UUID uuid, std::shared_ptr<Parameter> parameter);
 
+	// Declared first so that it outlives the instances, which the derived
+	// plugins' destructors destroy
+	Arena arena_;
 	blink_SR SR_ = 0;
 	std::vector<Group> groups_;
 	std::vector<std::shared_ptr<Parameter>> parameters_;
-	std::map<blink_UUID, Parameter*> uuid_parameter_map_;
-	std::set<Instance*> instances_;
+	UUIDTable<Parameter*> uuid_parameter_table_;
+	IntrusiveList<Instance, &Instance::plugin_hook_> instances_;
 };
 
 inline void Plugin::register_instance(Instance* instance)
@@ -71,12 +85,12 @@ inline void Plugin::register_instance(Instance* instance)
 		instance->stream_init(SR_);
 	}
 
-	instances_.insert(instance);
+	instances_.push_back(instance);
 }
 
 inline void Plugin::unregister_instance(Instance* instance)
 {
-	instances_.erase(instance);
+	instances_.remove(instance);
 }
 
 inline void Plugin::stream_init(blink_SR SR)
@@ -146,7 +160,7 @@ inline int Plugin::add_group(std::string name)
 inline void Plugin::add_parameter(blink_UUID uuid, std::shared_ptr<Parameter> parameter)
 {
 	parameters_.push_back(parameter);
-	uuid_parameter_map_[uuid] = parameter.get();
+	uuid_parameter_table_.insert(UUIDKey::from_string(uuid), parameter.get());
 }
 
 inline std::shared_ptr<ChordParameter> Plugin::add_parameter(ChordSpec spec)
@@ -205,6 +219,16 @@ inline int Plugin::get_num_parameters() const
 	return int(parameters_.size());
 }
 
+inline Arena& get_arena(Plugin* plugin)
+{
+	return plugin->get_arena();
+}
+
+inline int get_num_parameters(Instance* instance)
+{
+	return instance->get_plugin()->get_num_parameters();
+}
+
 inline const Group& Plugin::get_group(int index) const
 {
 	return groups_[index];
@@ -217,9 +241,14 @@ inline Parameter& Plugin::get_parameter(blink_Index index)
 
 inline Parameter& Plugin::get_parameter_by_uuid(blink_UUID uuid)
 {
-	auto pos = uuid_parameter_map_.find(uuid);
+	return *find_parameter_by_uuid(uuid);
+}
+
+inline Parameter* Plugin::find_parameter_by_uuid(blink_UUID uuid) const
+{
+	const auto parameter = uuid_parameter_table_.find(uuid);
 
-	return *pos->second;
+	return parameter ? *parameter : nullptr;
 }
 
 }
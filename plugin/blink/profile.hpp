@@ -0,0 +1,298 @@
+#pragma once
+
+#include <blink.h>
+
+//
+// Opt-in realtime profiling. Define BLINK_PROFILE when building the plugin
+// to enable it. Otherwise everything in here compiles away to nothing.
+//
+// Each unit records one Record per process call into its own lock-free ring
+// buffer. The audio thread writes and a single non-audio thread (the host
+// polling blink_get_profile_stats()) reads. If the ring fills up because
+// nobody is reading, new records are dropped and counted rather than
+// blocking the audio thread.
+//
+// While a unit is processing, a thread local pointer to its in-progress
+// record lets the envelope, sample and traverser code add their own timings
+// and counts without knowing which unit they are working for.
+//
+
+#ifdef BLINK_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace blink {
+namespace profile {
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+constexpr bool TIMESTAMP_COUNTER = true;
+
+inline std::uint64_t now() { return __rdtsc(); }
+#else
+constexpr bool TIMESTAMP_COUNTER = false;
+
+inline std::uint64_t now()
+{
+	return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+struct Record
+{
+	std::uint64_t process_time = 0;
+	std::uint64_t envelope_time = 0;
+	std::uint64_t sample_time = 0;
+	std::uint32_t num_resets = 0;
+	std::uint32_t num_binary_searches = 0;
+};
+
+namespace detail {
+
+//
+// With the default TLS model the first access from each thread in a
+// dlopen'd plugin goes through __tls_get_addr(), which allocates. The
+// initial-exec model uses the space glibc reserves up front instead
+//
+#if defined(__GNUC__) && !defined(_WIN32)
+#define BLINK_PROFILE_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define BLINK_PROFILE_TLS
+#endif
+
+inline Record*& current()
+{
+	static thread_local Record* record BLINK_PROFILE_TLS = nullptr;
+
+	return record;
+}
+
+}
+
+class UnitProfile
+{
+public:
+
+	static constexpr int CAPACITY = 256;
+
+	// Audio thread
+	void push(const Record& record)
+	{
+		const auto write = write_index_.load(std::memory_order_relaxed);
+		const auto read = read_index_.load(std::memory_order_acquire);
+
+		if (write - read >= CAPACITY)
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		records_[write % CAPACITY] = record;
+
+		write_index_.store(write + 1, std::memory_order_release);
+	}
+
+	// Polling thread. Aggregates and consumes every record written so far
+	void get_stats(blink_ProfileStats* out)
+	{
+		*out = blink_ProfileStats();
+
+		out->timestamp_counter = TIMESTAMP_COUNTER ? BLINK_TRUE : BLINK_FALSE;
+		out->num_dropped = dropped_.exchange(0, std::memory_order_relaxed);
+
+		const auto write = write_index_.load(std::memory_order_acquire);
+		auto read = read_index_.load(std::memory_order_relaxed);
+
+		for (; read < write; read++)
+		{
+			const auto& record = records_[read % CAPACITY];
+
+			out->num_calls++;
+			out->process_time += record.process_time;
+			out->process_time_max = std::max(out->process_time_max, record.process_time);
+			out->envelope_time += record.envelope_time;
+			out->sample_time += record.sample_time;
+			out->num_resets += record.num_resets;
+			out->num_binary_searches += record.num_binary_searches;
+		}
+
+		read_index_.store(read, std::memory_order_release);
+	}
+
+private:
+
+	Record records_[CAPACITY];
+	alignas(64) std::atomic<std::uint64_t> write_index_ { 0 };
+	alignas(64) std::atomic<std::uint64_t> read_index_ { 0 };
+	std::atomic<std::uint64_t> dropped_ { 0 };
+};
+
+//
+// Times one process call. Nested calls (e.g. process_batch() going through
+// the same wrapper) are folded into the outermost one
+//
+class CallScope
+{
+public:
+
+	CallScope(UnitProfile& profile)
+		: profile_(profile)
+		, outer_(detail::current() != nullptr)
+		, beg_(now())
+	{
+		if (!outer_) detail::current() = &record_;
+	}
+
+	~CallScope()
+	{
+		if (outer_) return;
+
+		record_.process_time = now() - beg_;
+
+		detail::current() = nullptr;
+
+		profile_.push(record_);
+	}
+
+private:
+
+	UnitProfile& profile_;
+	Record record_;
+	bool outer_;
+	std::uint64_t beg_;
+};
+
+//
+// Times a group of up to [MAX_UNITS] units which are processed together
+// (see SynthVoices). Everything recorded while the scope is open is shared
+// out evenly between the units' profiles when it closes
+//
+template <int MAX_UNITS>
+class GroupScope
+{
+public:
+
+	GroupScope()
+		: outer_(detail::current() != nullptr)
+		, beg_(now())
+	{
+		if (!outer_) detail::current() = &record_;
+	}
+
+	~GroupScope()
+	{
+		if (outer_) return;
+
+		record_.process_time = now() - beg_;
+
+		detail::current() = nullptr;
+
+		if (count_ < 1) return;
+
+		const auto share = [this](auto total, int index)
+		{
+			using T = decltype(total);
+
+			return T(total / T(count_)) + T(index < int(total % T(count_)) ? 1 : 0);
+		};
+
+		for (int i = 0; i < count_; i++)
+		{
+			Record record;
+
+			record.process_time = share(record_.process_time, i);
+			record.envelope_time = share(record_.envelope_time, i);
+			record.sample_time = share(record_.sample_time, i);
+			record.num_resets = share(record_.num_resets, i);
+			record.num_binary_searches = share(record_.num_binary_searches, i);
+
+			profiles_[i]->push(record);
+		}
+	}
+
+	void add(UnitProfile& profile)
+	{
+		if (count_ < MAX_UNITS) profiles_[count_++] = &profile;
+	}
+
+private:
+
+	Record record_;
+	UnitProfile* profiles_[MAX_UNITS];
+	int count_ = 0;
+	bool outer_;
+	std::uint64_t beg_;
+};
+
+//
+// Adds the time spent in a scope to one of the current record's timers.
+// Does nothing if no unit is being processed on this thread
+//
+template <std::uint64_t Record::*Timer>
+class TimerScope
+{
+public:
+
+	TimerScope()
+		: record_(detail::current())
+		, beg_(record_ ? now() : 0)
+	{
+	}
+
+	~TimerScope()
+	{
+		if (record_) record_->*Timer += now() - beg_;
+	}
+
+private:
+
+	Record* record_;
+	std::uint64_t beg_;
+};
+
+using EnvelopeScope = TimerScope<&Record::envelope_time>;
+using SampleScope = TimerScope<&Record::sample_time>;
+
+inline void count_resets(int count)
+{
+	if (const auto record = detail::current()) record->num_resets += std::uint32_t(count);
+}
+
+inline void count_binary_search()
+{
+	if (const auto record = detail::current()) record->num_binary_searches++;
+}
+
+}}
+
+#else
+
+namespace blink {
+namespace profile {
+
+class UnitProfile
+{
+public:
+
+	void get_stats(blink_ProfileStats* out) { *out = blink_ProfileStats(); }
+};
+
+struct CallScope { CallScope(UnitProfile&) {} };
+template <int MAX_UNITS> struct GroupScope { void add(UnitProfile&) {} };
+struct EnvelopeScope { EnvelopeScope() {} };
+struct SampleScope { SampleScope() {} };
+
+inline void count_resets(int) {}
+inline void count_binary_search() {}
+
+}}
+
+#endif
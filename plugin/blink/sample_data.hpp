@@ -3,6 +3,7 @@
 #include <cmath>
 #include <blink_sampler.h>
 #include "math.hpp"
+#include "profile.hpp"
 
 namespace blink {
 
@@ -18,12 +19,17 @@ public:
 	blink_FrameCount get_data(blink_ChannelCount channel, blink_Index index, blink_FrameCount size, float* buffer) const;
 	float read_frame(blink_ChannelCount channel, int pos) const;
 	float read_frame_interp(blink_ChannelCount channel, float pos, bool loop = false) const;
+	float read_frame_interp(blink_ChannelCount channel, FixedPosition pos, bool loop = false) const;
 	ml::DSPVector read_frames(blink_ChannelCount channel, const ml::DSPVectorInt& pos) const;
 	ml::DSPVector read_frames_interp(blink_ChannelCount channel, const snd::transport::DSPVectorFramePosition& pos, bool loop) const;
+	ml::DSPVector read_frames_interp(blink_ChannelCount channel, const FixedPositionVector& pos, bool loop) const;
 
 	template <std::size_t ROWS>
 	ml::DSPVectorArray<ROWS> read_frames_interp(const snd::transport::DSPVectorFramePosition& pos, bool loop) const;
 
+	template <std::size_t ROWS>
+	ml::DSPVectorArray<ROWS> read_frames_interp(const FixedPositionVector& pos, bool loop) const;
+
 	blink_ChannelMode get_channel_mode() const { return channel_mode_; }
 
 private:
@@ -43,7 +49,12 @@ private:
 	};
 
 	InterpPos get_interp_pos(float pos, bool loop = false) const;
+	InterpPos get_interp_pos(FixedPosition pos, bool loop = false) const;
 	InterpVectorPos get_interp_pos(snd::transport::DSPVectorFramePosition pos, bool loop) const;
+	InterpVectorPos get_interp_pos(const FixedPositionVector& pos, bool loop) const;
+
+	template <std::size_t ROWS>
+	ml::DSPVectorArray<ROWS> read_frames_interp(const InterpVectorPos& interp_pos) const;
 
 	const blink_SampleInfo* info_;
 	blink_ChannelMode channel_mode_;
@@ -62,6 +73,8 @@ inline blink_FrameCount SampleData::get_data(blink_ChannelCount channel, blink_I
 
 inline float SampleData::read_frame(blink_ChannelCount channel, int pos) const
 {
+	profile::SampleScope profile_scope;
+
 	if (pos < 0 || pos >= int(info_->num_frames))
 	{
 		return 0.0f;
@@ -79,6 +92,8 @@ inline float SampleData::read_frame(blink_ChannelCount channel, int pos) const
 
 inline ml::DSPVector SampleData::read_frames(blink_ChannelCount channel, const ml::DSPVectorInt& pos) const
 {
+	profile::SampleScope profile_scope;
+
 	ml::DSPVector out;
 
 	for (int i = 0; i < kFloatsPerDSPVector; i++)
@@ -125,6 +140,44 @@ inline auto SampleData::get_interp_pos(snd::transport::DSPVectorFramePosition po
 	return out;
 }
 
+//
+// With fixed point positions the frame index and fraction are just the upper
+// and lower 32 bits
+//
+inline auto SampleData::get_interp_pos(FixedPosition pos, bool loop) const -> InterpPos
+{
+	InterpPos out;
+
+	// An empty sample has nothing to wrap around, every read returns zero
+	if (loop && info_->num_frames > 0)
+	{
+		const auto y = std::int64_t(info_->num_frames) << FixedPosition::FRACT_BITS;
+
+		pos.value %= y;
+
+		if (pos.value < 0) pos.value += y;
+	}
+
+	out.prev = int(pos.frame());
+	out.next = out.prev + 1;
+	out.x = pos.fract();
+
+	return out;
+}
+
+inline auto SampleData::get_interp_pos(const FixedPositionVector& pos, bool loop) const -> InterpVectorPos
+{
+	InterpVectorPos out;
+
+	const auto wrapped = loop ? math::wrap(pos, std::int64_t(info_->num_frames)) : pos;
+
+	out.prev = math::floor(wrapped);
+	out.next = math::ceil(wrapped);
+	out.x = wrapped.fract();
+
+	return out;
+}
+
 inline float SampleData::read_frame_interp(blink_ChannelCount channel, float pos, bool loop) const
 {
 	const auto interp_pos = get_interp_pos(pos, loop);
@@ -135,6 +188,26 @@ inline float SampleData::read_frame_interp(blink_ChannelCount channel, float pos
 	return (interp_pos.x * (next_value - prev_value)) + prev_value;
 }
 
+inline float SampleData::read_frame_interp(blink_ChannelCount channel, FixedPosition pos, bool loop) const
+{
+	const auto interp_pos = get_interp_pos(pos, loop);
+
+	const auto next_value = read_frame(channel, interp_pos.next);
+	const auto prev_value = read_frame(channel, interp_pos.prev);
+
+	return (interp_pos.x * (next_value - prev_value)) + prev_value;
+}
+
+inline ml::DSPVector SampleData::read_frames_interp(blink_ChannelCount channel, const FixedPositionVector& pos, bool loop) const
+{
+	const auto interp_pos = get_interp_pos(pos, loop);
+
+	const auto next_value = read_frames(channel, interp_pos.next);
+	const auto prev_value = read_frames(channel, interp_pos.prev);
+
+	return (interp_pos.x * (next_value - prev_value)) + prev_value;
+}
+
 inline ml::DSPVector SampleData::read_frames_interp(blink_ChannelCount channel, const snd::transport::DSPVectorFramePosition& pos, bool loop) const
 {
 	const auto interp_pos = get_interp_pos(pos, loop);
@@ -148,9 +221,19 @@ inline ml::DSPVector SampleData::read_frames_interp(blink_ChannelCount channel,
 template <std::size_t ROWS>
 inline ml::DSPVectorArray<ROWS> SampleData::read_frames_interp(const snd::transport::DSPVectorFramePosition& pos, bool loop) const
 {
-	ml::DSPVectorArray<ROWS> out;
+	return read_frames_interp<ROWS>(get_interp_pos(pos, loop));
+}
 
-	const auto interp_pos = get_interp_pos(pos, loop);
+template <std::size_t ROWS>
+inline ml::DSPVectorArray<ROWS> SampleData::read_frames_interp(const FixedPositionVector& pos, bool loop) const
+{
+	return read_frames_interp<ROWS>(get_interp_pos(pos, loop));
+}
+
+template <std::size_t ROWS>
+inline ml::DSPVectorArray<ROWS> SampleData::read_frames_interp(const InterpVectorPos& interp_pos) const
+{
+	ml::DSPVectorArray<ROWS> out;
 
 	for (int r = 0; r < ROWS; r++)
 	{
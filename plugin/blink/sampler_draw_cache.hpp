@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+#include <blink_sampler.h>
+#include "worker_pool.hpp"
+
+namespace blink {
+
+//
+// Remembers the last set of waveform columns calculated for each sampler
+// block so that blink_sampler_draw() only has to calculate the columns which
+// were not already on screen.
+//
+// Blocks are identified by their parameter data pointer. A hash of the
+// parameter values, warp points and sample info is stored alongside each
+// entry and if any of those changed the whole range is recalculated.
+//
+// Columns are matched up by their block position, so scrolling reuses every
+// column which is still visible and zooming by a whole factor reuses every
+// column which lands on a previously calculated position. Hosts usually
+// recalculate the positions as [start + (i * step)] after a scroll, which
+// is almost never bit identical to the positions from the last draw, so two
+// positions match if they are within COLUMN_TOLERANCE of the spacing
+// between columns.
+//
+// This relies on the draw function being seekable, i.e. the output for each
+// column only depends on that column's position (which is true of the
+// standard traversers.) The columns passed to the draw function will still
+// be in ascending order but there may be gaps between them.
+//
+// Not thread safe. Call from the UI thread
+//
+class SamplerDrawCache
+{
+public:
+
+	enum Outputs
+	{
+		Outputs_SculptedSamplePositions = 1 << 0,
+		Outputs_WarpedSamplePositions   = 1 << 1,
+		Outputs_SculptedBlockPositions  = 1 << 2,
+		Outputs_WarpedBlockPositions    = 1 << 3,
+		Outputs_FinalSamplePositions    = 1 << 4,
+		Outputs_WaveformDerivatives     = 1 << 5,
+		Outputs_Amp                     = 1 << 6,
+	};
+
+	SamplerDrawCache(int max_entries = 64)
+		: max_entries_(max_entries)
+	{
+	}
+
+	//
+	// [draw_fn] has the same signature as blink_sampler_draw() and is only
+	// called for the columns which need calculating
+	//
+	template <class DrawFn>
+	blink_Error draw(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out, int num_parameters, DrawFn&& draw_fn);
+
+	void clear() { entries_.clear(); }
+
+	//
+	// With [num_threads] > 0 the columns which need calculating are split
+	// into chunks which are calculated in parallel. The draw function must
+	// then be safe to call from several threads at once, i.e. it should
+	// create its own traversers rather than sharing them. Each chunk starts
+	// with a fresh traverser which seeks to the chunk's first position.
+	//
+	void set_num_threads(int num_threads);
+
+private:
+
+	// Chunks are never made smaller than this
+	static constexpr blink_FrameCount MIN_CHUNK_SIZE = BLINK_VECTOR_SIZE * 4;
+
+	// Fraction of the smallest column spacing within which two positions are
+	// treated as the same column
+	static constexpr double COLUMN_TOLERANCE = 1.0e-6;
+
+	template <class DrawFn>
+	blink_Error draw_chunks(const blink_SamplerBuffer* buffer, std::size_t n, const blink_SamplerDrawInfo& out, DrawFn& draw_fn);
+
+	struct Entry
+	{
+		std::uint64_t hash = 0;
+		std::uint64_t last_use = 0;
+		int outputs = 0;
+
+		std::vector<blink_Position> positions;
+		std::vector<double> sculpted_sample_positions;
+		std::vector<double> warped_sample_positions;
+		std::vector<double> sculpted_block_positions;
+		std::vector<double> warped_block_positions;
+		std::vector<double> final_sample_positions;
+		std::vector<float> waveform_derivatives;
+		std::vector<float> amp;
+	};
+
+	static int get_outputs(const blink_SamplerDrawInfo* info);
+	static std::uint64_t hash(const blink_SamplerBuffer* buffer, int num_parameters);
+	static double get_min_spacing(const blink_Position* positions, blink_FrameCount n);
+
+	Entry& get_entry(const blink_ParameterData* key);
+
+	int max_entries_;
+	std::uint64_t use_counter_ = 0;
+	std::map<const blink_ParameterData*, Entry> entries_;
+
+	// Scratch space for the columns being calculated
+	std::vector<std::int64_t> sources_;
+	std::vector<blink_FrameCount> missing_;
+	Entry scratch_;
+
+	std::unique_ptr<WorkerPool> worker_pool_;
+};
+
+namespace draw_cache_hash {
+
+// FNV-1a
+constexpr std::uint64_t BASIS = 14695981039346656037ULL;
+constexpr std::uint64_t PRIME = 1099511628211ULL;
+
+inline std::uint64_t bytes(std::uint64_t hash, const void* data, std::size_t size)
+{
+	const auto bytes = static_cast<const unsigned char*>(data);
+
+	for (std::size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= PRIME;
+	}
+
+	return hash;
+}
+
+template <class T>
+inline std::uint64_t value(std::uint64_t hash, const T& value)
+{
+	return bytes(hash, &value, sizeof(T));
+}
+
+} // draw_cache_hash
+
+inline int SamplerDrawCache::get_outputs(const blink_SamplerDrawInfo* info)
+{
+	int out = 0;
+
+	if (info->sculpted_sample_positions) out |= Outputs_SculptedSamplePositions;
+	if (info->warped_sample_positions) out |= Outputs_WarpedSamplePositions;
+	if (info->sculpted_block_positions) out |= Outputs_SculptedBlockPositions;
+	if (info->warped_block_positions) out |= Outputs_WarpedBlockPositions;
+	if (info->final_sample_positions) out |= Outputs_FinalSamplePositions;
+	if (info->waveform_derivatives) out |= Outputs_WaveformDerivatives;
+	if (info->amp) out |= Outputs_Amp;
+
+	return out;
+}
+
+inline std::uint64_t SamplerDrawCache::hash(const blink_SamplerBuffer* buffer, int num_parameters)
+{
+	using namespace draw_cache_hash;
+
+	auto out = BASIS;
+
+	out = value(out, buffer->song_rate);
+	out = value(out, buffer->data_offset);
+	out = value(out, buffer->channel_mode);
+
+	if (buffer->sample_info)
+	{
+		out = value(out, buffer->sample_info->id);
+		out = value(out, buffer->sample_info->num_channels);
+		out = value(out, buffer->sample_info->num_frames);
+		out = value(out, buffer->sample_info->SR);
+		out = value(out, buffer->sample_info->analysis_ready);
+	}
+
+	if (buffer->warp_points)
+	{
+		out = value(out, buffer->warp_points->count);
+		out = bytes(out, buffer->warp_points->points, sizeof(blink_WarpPoint) * buffer->warp_points->count);
+	}
+
+	if (!buffer->parameter_data) return out;
+
+	for (int i = 0; i < num_parameters; i++)
+	{
+		const auto& data = buffer->parameter_data[i];
+
+		out = value(out, data.type);
+
+		switch (data.type)
+		{
+			case blink_ParameterType_Chord:
+			{
+				out = value(out, data.chord.blocks.count);
+				out = bytes(out, data.chord.blocks.blocks, sizeof(blink_ChordBlock) * data.chord.blocks.count);
+				break;
+			}
+
+			case blink_ParameterType_Envelope:
+			{
+				out = value(out, data.envelope.min);
+				out = value(out, data.envelope.max);
+				out = value(out, data.envelope.options);
+				out = value(out, data.envelope.points.count);
+				out = bytes(out, data.envelope.points.points, sizeof(blink_EnvelopePoint) * data.envelope.points.count);
+				break;
+			}
+
+			case blink_ParameterType_Option:
+			{
+				out = value(out, data.option.index);
+				break;
+			}
+
+			case blink_ParameterType_Slider:
+			{
+				out = value(out, data.slider.value);
+				break;
+			}
+
+			case blink_ParameterType_IntSlider:
+			{
+				out = value(out, data.int_slider.value);
+				break;
+			}
+
+			case blink_ParameterType_Toggle:
+			{
+				out = value(out, data.toggle.value);
+				break;
+			}
+		}
+	}
+
+	return out;
+}
+
+//
+// Smallest distance between two neighbouring positions. Zero if they aren't
+// in ascending order
+//
+inline double SamplerDrawCache::get_min_spacing(const blink_Position* positions, blink_FrameCount n)
+{
+	auto out = std::numeric_limits<double>::infinity();
+
+	for (blink_FrameCount i = 1; i < n; i++)
+	{
+		const auto spacing = positions[i] - positions[i - 1];
+
+		if (!(spacing > 0.0)) return 0.0;
+
+		out = std::min(out, spacing);
+	}
+
+	return out;
+}
+
+inline SamplerDrawCache::Entry& SamplerDrawCache::get_entry(const blink_ParameterData* key)
+{
+	auto pos = entries_.find(key);
+
+	if (pos != entries_.end()) return pos->second;
+
+	//
+	// Make room by dropping the least recently drawn block
+	//
+	if (max_entries_ > 0 && int(entries_.size()) >= max_entries_)
+	{
+		auto oldest = entries_.begin();
+
+		for (auto entry = entries_.begin(); entry != entries_.end(); entry++)
+		{
+			if (entry->second.last_use < oldest->second.last_use) oldest = entry;
+		}
+
+		entries_.erase(oldest);
+	}
+
+	return entries_[key];
+}
+
+inline void SamplerDrawCache::set_num_threads(int num_threads)
+{
+	worker_pool_.reset();
+
+	if (num_threads > 0)
+	{
+		worker_pool_ = std::make_unique<WorkerPool>(num_threads);
+	}
+}
+
+template <class DrawFn>
+inline blink_Error SamplerDrawCache::draw_chunks(const blink_SamplerBuffer* buffer, std::size_t n, const blink_SamplerDrawInfo& out, DrawFn& draw_fn)
+{
+	const auto draw_range = [&](std::size_t beg, std::size_t end)
+	{
+		auto chunk_buffer = *buffer;
+		auto chunk_out = out;
+
+		chunk_buffer.positions = scratch_.positions.data() + beg;
+
+		const auto offset = [beg](auto** ptr)
+		{
+			if (*ptr) *ptr += beg;
+		};
+
+		offset(&chunk_out.sculpted_sample_positions);
+		offset(&chunk_out.warped_sample_positions);
+		offset(&chunk_out.sculpted_block_positions);
+		offset(&chunk_out.warped_block_positions);
+		offset(&chunk_out.final_sample_positions);
+		offset(&chunk_out.waveform_derivatives);
+		offset(&chunk_out.amp);
+
+		return draw_fn(&chunk_buffer, blink_FrameCount(end - beg), &chunk_out);
+	};
+
+	if (!worker_pool_ || n < MIN_CHUNK_SIZE * 2)
+	{
+		return draw_range(0, n);
+	}
+
+	//
+	// One chunk per thread, rounded up to a whole number of vectors
+	//
+	const auto num_threads = std::size_t(worker_pool_->get_num_threads());
+
+	auto chunk_size = (n + num_threads - 1) / num_threads;
+
+	chunk_size = ((chunk_size + BLINK_VECTOR_SIZE - 1) / BLINK_VECTOR_SIZE) * BLINK_VECTOR_SIZE;
+	chunk_size = std::max(chunk_size, std::size_t(MIN_CHUNK_SIZE));
+
+	const auto num_chunks = int((n + chunk_size - 1) / chunk_size);
+
+	std::vector<blink_Error> results(num_chunks, BLINK_OK);
+
+	worker_pool_->run(num_chunks, [&](int chunk)
+	{
+		const auto beg = std::size_t(chunk) * chunk_size;
+		const auto end = std::min(beg + chunk_size, n);
+
+		results[chunk] = draw_range(beg, end);
+	});
+
+	for (const auto result : results)
+	{
+		if (result != BLINK_OK) return result;
+	}
+
+	return BLINK_OK;
+}
+
+template <class DrawFn>
+inline blink_Error SamplerDrawCache::draw(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out, int num_parameters, DrawFn&& draw_fn)
+{
+	const auto min_spacing = n > 0 ? get_min_spacing(buffer->positions, n) : 0.0;
+
+	if (!(min_spacing > 0.0))
+	{
+		return draw_fn(buffer, n, out);
+	}
+
+	// A single column has nothing to measure the spacing against so it has
+	// to match exactly
+	const auto tolerance = std::isinf(min_spacing) ? 0.0 : min_spacing * COLUMN_TOLERANCE;
+
+	auto& entry = get_entry(buffer->parameter_data);
+
+	const auto outputs = get_outputs(out);
+	const auto buffer_hash = hash(buffer, num_parameters);
+
+	if (entry.hash != buffer_hash || (entry.outputs & outputs) != outputs)
+	{
+		entry.positions.clear();
+	}
+
+	entry.last_use = ++use_counter_;
+
+	//
+	// Walk the old and new positions together to find the columns which were
+	// already calculated
+	//
+	sources_.assign(n, -1);
+	missing_.clear();
+
+	std::size_t old_index = 0;
+
+	for (blink_FrameCount i = 0; i < n; i++)
+	{
+		const auto position = buffer->positions[i];
+
+		while (old_index < entry.positions.size() && entry.positions[old_index] < position - tolerance) old_index++;
+
+		if (old_index < entry.positions.size() && std::abs(entry.positions[old_index] - position) <= tolerance)
+		{
+			sources_[i] = std::int64_t(old_index);
+		}
+		else
+		{
+			missing_.push_back(i);
+		}
+	}
+
+	//
+	// Calculate the missing columns in as few calls as possible
+	//
+	const auto num_missing = missing_.size();
+
+	scratch_.positions.resize(num_missing);
+
+	for (std::size_t i = 0; i < num_missing; i++)
+	{
+		scratch_.positions[i] = buffer->positions[missing_[i]];
+	}
+
+	blink_SamplerDrawInfo scratch_out = {};
+
+	const auto prepare = [num_missing](auto* vec, auto* requested, auto** dest)
+	{
+		if (!requested) return;
+
+		vec->resize(num_missing);
+		*dest = vec->data();
+	};
+
+	prepare(&scratch_.sculpted_sample_positions, out->sculpted_sample_positions, &scratch_out.sculpted_sample_positions);
+	prepare(&scratch_.warped_sample_positions, out->warped_sample_positions, &scratch_out.warped_sample_positions);
+	prepare(&scratch_.sculpted_block_positions, out->sculpted_block_positions, &scratch_out.sculpted_block_positions);
+	prepare(&scratch_.warped_block_positions, out->warped_block_positions, &scratch_out.warped_block_positions);
+	prepare(&scratch_.final_sample_positions, out->final_sample_positions, &scratch_out.final_sample_positions);
+	prepare(&scratch_.waveform_derivatives, out->waveform_derivatives, &scratch_out.waveform_derivatives);
+	prepare(&scratch_.amp, out->amp, &scratch_out.amp);
+
+	if (num_missing > 0)
+	{
+		const auto result = draw_chunks(buffer, num_missing, scratch_out, draw_fn);
+
+		if (result != BLINK_OK)
+		{
+			entry.positions.clear();
+
+			return result;
+		}
+	}
+
+	//
+	// Merge the cached and newly calculated columns into the output
+	//
+	const auto merge = [&](const auto& cached, const auto& calculated, auto* dest)
+	{
+		if (!dest) return;
+
+		std::size_t missing_index = 0;
+
+		for (blink_FrameCount i = 0; i < n; i++)
+		{
+			dest[i] = sources_[i] >= 0 ? cached[std::size_t(sources_[i])] : calculated[missing_index++];
+		}
+	};
+
+	merge(entry.sculpted_sample_positions, scratch_.sculpted_sample_positions, out->sculpted_sample_positions);
+	merge(entry.warped_sample_positions, scratch_.warped_sample_positions, out->warped_sample_positions);
+	merge(entry.sculpted_block_positions, scratch_.sculpted_block_positions, out->sculpted_block_positions);
+	merge(entry.warped_block_positions, scratch_.warped_block_positions, out->warped_block_positions);
+	merge(entry.final_sample_positions, scratch_.final_sample_positions, out->final_sample_positions);
+	merge(entry.waveform_derivatives, scratch_.waveform_derivatives, out->waveform_derivatives);
+	merge(entry.amp, scratch_.amp, out->amp);
+
+	//
+	// The output now holds everything for this range so it becomes the new
+	// cache entry
+	//
+	const auto store = [n](auto* vec, const auto* src)
+	{
+		if (src) vec->assign(src, src + n);
+		else vec->clear();
+	};
+
+	entry.hash = buffer_hash;
+	entry.outputs = outputs;
+
+	store(&entry.positions, buffer->positions);
+	store(&entry.sculpted_sample_positions, out->sculpted_sample_positions);
+	store(&entry.warped_sample_positions, out->warped_sample_positions);
+	store(&entry.sculpted_block_positions, out->sculpted_block_positions);
+	store(&entry.warped_block_positions, out->warped_block_positions);
+	store(&entry.final_sample_positions, out->final_sample_positions);
+	store(&entry.waveform_derivatives, out->waveform_derivatives);
+	store(&entry.amp, out->amp);
+
+	return BLINK_OK;
+}
+
+}
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <set>
+#include <utility>
 #include <blink/plugin.hpp>
+#include <blink/sampler_draw_cache.hpp>
 #include <blink/sampler_instance.hpp>
 
 namespace blink {
@@ -15,18 +16,35 @@ public:
 	SamplerInstance* add_instance();
 	void destroy_instance(SamplerInstance* instance);
 
+	//
+	// For implementing blink_sampler_draw(). [draw_fn] has the same
+	// signature and only gets called for the columns which are not
+	// already cached (see SamplerDrawCache)
+	//
+	template <class DrawFn>
+	blink_Error draw(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out, DrawFn&& draw_fn);
+
+	// See SamplerDrawCache::set_num_threads()
+	void set_draw_threads(int num_threads) { draw_cache_.set_num_threads(num_threads); }
+
+	//
+	// For use inside blink_sampler_preprocess_sample(). Reports progress to
+	// the host and records it on the trace timeline (see trace.hpp)
+	//
+	static void report_preprocess_progress(void* host, const blink_PreprocessCallbacks& callbacks, const blink_SampleInfo* sample_info, float progress);
+
 private:
 
 	virtual SamplerInstance* make_instance() = 0;
 
-	std::set<SamplerInstance*> instances_;
+	SamplerDrawCache draw_cache_;
 };
 
 inline SamplerPlugin::~SamplerPlugin()
 {
-	for (auto instance : instances_)
+	while (const auto instance = first_instance())
 	{
-		delete instance;
+		destroy_instance(static_cast<SamplerInstance*>(instance));
 	}
 }
 
@@ -34,7 +52,6 @@ inline SamplerInstance* SamplerPlugin::add_instance()
 {
 	const auto instance = make_instance();
 
-	instances_.insert(instance);
 	register_instance(instance);
 
 	return instance;
@@ -42,9 +59,21 @@ inline SamplerInstance* SamplerPlugin::add_instance()
 
 inline void SamplerPlugin::destroy_instance(SamplerInstance* instance)
 {
-	instances_.erase(instance);
 	unregister_instance(instance);
 	delete instance;
 }
 
+inline void SamplerPlugin::report_preprocess_progress(void* host, const blink_PreprocessCallbacks& callbacks, const blink_SampleInfo* sample_info, float progress)
+{
+	trace::counter("preprocess", sample_info->id, progress);
+
+	callbacks.report_progress(host, progress);
+}
+
+template <class DrawFn>
+inline blink_Error SamplerPlugin::draw(const blink_SamplerBuffer* buffer, blink_FrameCount n, blink_SamplerDrawInfo* out, DrawFn&& draw_fn)
+{
+	return draw_cache_.draw(buffer, n, out, get_num_parameters(), std::forward<DrawFn>(draw_fn));
+}
+
 } // tract
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "sample_data.hpp"
 #include "slider_spec.hpp"
 #include "instance.hpp"
+#include "plugin.hpp"
 #include "unit.hpp"
 
 namespace blink {
@@ -26,11 +27,85 @@ public:
 
 	blink_Error sampler_process(const blink_SamplerBuffer* buffer, float* out)
 	{
+		if (!is_active()) return blink_StdError_UnitInactive;
+
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("sampler_process", this, buffer->buffer_id);
+
 		get_instance()->begin_process(buffer->buffer_id);
 
 		Unit::begin_process(buffer->buffer_id, buffer->positions, buffer->data_offset);
 
-		return process(buffer, out);
+		update_parameter_changes();
+
+		begin_vector();
+
+		const auto result = process(buffer, out);
+
+		end_vector(out, 0);
+
+		return result;
+	}
+
+	//
+	// For implementing blink_sampler_process_batch(). Units are processed back to
+	// back without going through the function pointers
+	//
+	static blink_Error process_batch(blink_SamplerJob* jobs, blink_Index count)
+	{
+		blink_Error out = BLINK_OK;
+
+		for (blink_Index i = 0; i < count; i++)
+		{
+			auto& job = jobs[i];
+			auto unit = (SamplerUnit*)(job.proc_data);
+
+			job.result = unit->sampler_process(job.buffer, job.out);
+
+			if (job.result != BLINK_OK && out == BLINK_OK)
+			{
+				out = job.result;
+			}
+		}
+
+		return out;
+	}
+
+	blink_Error sampler_process_vectors(const blink_SamplerBuffer* buffer, blink_Index num_vectors, float* out)
+	{
+		if (num_vectors < 1) return blink_StdError_InvalidArgument;
+		if (!is_active()) return blink_StdError_UnitInactive;
+
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("sampler_process_vectors", this, buffer->buffer_id);
+
+		get_instance()->begin_process(buffer->buffer_id, int(num_vectors));
+
+		Unit::begin_process(buffer->buffer_id, int(num_vectors));
+
+		auto vector_buffer = *buffer;
+
+		for (blink_Index i = 0; i < num_vectors; i++)
+		{
+			vector_buffer.buffer_id = buffer->buffer_id + i;
+			vector_buffer.positions = buffer->positions + (i * BLINK_VECTOR_SIZE);
+
+			Unit::set_positions(vector_buffer.positions, buffer->data_offset);
+
+			update_parameter_changes();
+
+			const auto vector_out = out + (i * BLINK_VECTOR_SIZE * 2);
+
+			begin_vector();
+
+			const auto result = process(&vector_buffer, vector_out);
+
+			end_vector(vector_out, int(i));
+
+			if (result != BLINK_OK) return result;
+		}
+
+		return BLINK_OK;
 	}
 
 protected:
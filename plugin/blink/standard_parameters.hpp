@@ -1,5 +1,7 @@
 #pragma once
 
+#include <regex>
+#include <sstream>
 #include <tweak/tweak.hpp>
 #include <tweak/std.hpp>
 #include "math.hpp"
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
 #include "../traverser.hpp"
 #include "../envelope_parameter.hpp"
 #include "../slider_parameter.hpp"
@@ -39,10 +40,44 @@ template <class T> T weird_math_that_i_dont_understand_ff(T min, T max, T distan
 	return math::convert::p_to_ff(min) * std::pow(ratio(min, max, distance), n);
 }
 
+//
+// e^x - 1 for a vector of x values. When x stays close to zero a polynomial
+// is used instead because subtracting one from e^x would throw away most of
+// the precision
+//
+inline ml::DSPVector expm1(const ml::DSPVector& x, float max_abs_x)
+{
+	if (max_abs_x < 0.1f)
+	{
+		return x * (1.0f + x * (0.5f + x * ((1.0f / 6.0f) + x * ((1.0f / 24.0f) + x * (1.0f / 120.0f)))));
+	}
+
+	return ml::exp(x) - 1.0f;
+}
+
 class ClassicCalculator
 {
 public:
 
+	// The envelope segment which was used for the last calculation. Within a
+	// segment the sample position is a geometric series of the block position
+	// so any number of positions can be evaluated without searching
+	struct Segment
+	{
+		// Block position range covered by the segment
+		blink_Position beg = 0.0;
+		blink_Position end = 0.0;
+
+		// Block position of the segment start
+		blink_Position x0 = 0.0;
+
+		// Frequency factor at x0
+		double ff0 = 1.0;
+
+		// The frequency factor is multiplied by this for every block frame
+		double ratio = 1.0;
+	};
+
 	// We use this for both sample playback and waveform generation. This
 	// calculation needs to be fast, preferably O(n) or better.
 	//
@@ -56,7 +91,8 @@ public:
 	// the mathematics involved in calculating the resulting sample
 	// position.
 	//
-	blink_Position calculate(float transpose, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative = nullptr)
+	template <bool Derivative>
+	blink_Position calculate(float transpose, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative)
 	{
 		struct PitchPoint
 		{
@@ -97,7 +133,13 @@ public:
 				{
 					point_search_index_ = 0;
 
-					if (derivative) *derivative = p1.get_ff();
+					segment_.beg = -std::numeric_limits<blink_Position>::infinity();
+					segment_.end = p1.x;
+					segment_.x0 = 0.0;
+					segment_.ff0 = p1.get_ff();
+					segment_.ratio = 1.0;
+
+					if constexpr (Derivative) *derivative = p1.get_ff();
 
 					return (block_position * p1.get_ff()) + segment_start_;
 				}
@@ -111,7 +153,13 @@ public:
 				{
 					point_search_index_ = i;
 
-					if (derivative) *derivative = float(weird_math_that_i_dont_understand_ff(double(p0.pitch), double(p1.pitch), segment_size, n));
+					segment_.beg = p0.x;
+					segment_.end = p1.x;
+					segment_.x0 = p0.x;
+					segment_.ff0 = math::convert::p_to_ff(double(p0.pitch));
+					segment_.ratio = ratio(double(p0.pitch), double(p1.pitch), segment_size);
+
+					if constexpr (Derivative) *derivative = float(weird_math_that_i_dont_understand_ff(double(p0.pitch), double(p1.pitch), segment_size, n));
 
 					return (weird_math_that_i_dont_understand(double(p0.pitch), double(p1.pitch), segment_size, n)) + segment_start_;
 				}
@@ -144,11 +192,106 @@ public:
 
 		auto n = block_position - p0.x;
 
-		if (derivative) *derivative = p0.get_ff();
+		segment_.beg = p0.x;
+		segment_.end = std::numeric_limits<blink_Position>::infinity();
+		segment_.x0 = p0.x;
+		segment_.ff0 = p0.get_ff();
+		segment_.ratio = 1.0;
+
+		if constexpr (Derivative) *derivative = p0.get_ff();
 
 		return (n * p0.get_ff()) + segment_start_;
 	}
 
+	blink_Position calculate(float transpose, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative = nullptr)
+	{
+		return derivative
+			? calculate<true>(transpose, envelope, block_position, derivative)
+			: calculate<false>(transpose, envelope, block_position, nullptr);
+	}
+
+	//
+	// Evaluates block positions [beg + 1, end) which must all lie inside the
+	// segment used by the last call to calculate(). That call was for block
+	// position [beg] and returned [value].
+	//
+	// The calculator state is left exactly as if calculate() had been called
+	// for each position.
+	//
+	template <bool Derivatives>
+	void calculate_run(
+		const FixedPositionVector& block_positions,
+		int beg,
+		int end,
+		blink_Position value,
+		blink_Position offset,
+		FixedPositionVector* out,
+		ml::DSPVector* derivatives) const
+	{
+		const blink_Position x = block_positions[beg];
+
+		if (end - beg < MIN_VECTOR_RUN)
+		{
+			calculate_short_run<Derivatives>(block_positions, beg, end, value, offset, out, derivatives);
+			return;
+		}
+
+		ml::DSPVector distance(0.0f);
+		float max_distance = 0.0f;
+
+		for (int i = beg + 1; i < end; i++)
+		{
+			distance[i] = float(double(block_positions.values[i] - block_positions.values[beg]) * (1.0 / double(FixedPosition::ONE)));
+			max_distance = std::max(max_distance, std::abs(distance[i]));
+		}
+
+		if (std::abs(1.0 - segment_.ratio) <= 0.0)
+		{
+			const auto ff = float(segment_.ff0);
+			const auto delta = distance * ff;
+
+			for (int i = beg + 1; i < end; i++)
+			{
+				out->set(i, (value + delta[i]) - offset);
+			}
+
+			if constexpr (Derivatives)
+			{
+				for (int i = beg + 1; i < end; i++)
+				{
+					derivatives->getBuffer()[i] = ff;
+				}
+			}
+
+			return;
+		}
+
+		// The rate of change at the start of the run, and the rate at which
+		// it is growing or shrinking per frame
+		const auto ff = segment_.ff0 * std::pow(segment_.ratio, x - segment_.x0);
+		const auto log_ratio = std::log(segment_.ratio);
+
+		const auto growth = expm1(distance * float(log_ratio), max_distance * float(std::abs(log_ratio)));
+		const auto delta = growth * float(ff / std::expm1(log_ratio));
+
+		for (int i = beg + 1; i < end; i++)
+		{
+			out->set(i, (value + delta[i]) - offset);
+		}
+
+		if constexpr (Derivatives)
+		{
+			const auto run_derivatives = (growth + 1.0f) * float(ff);
+
+			for (int i = beg + 1; i < end; i++)
+			{
+				derivatives->getBuffer()[i] = run_derivatives[i];
+			}
+		}
+	}
+
+	const Segment& segment() const { return segment_; }
+
 	void reset()
 	{
 		segment_start_ = 0.0f;
@@ -157,14 +300,72 @@ public:
 
 private:
 
+	// Runs shorter than this are evaluated one position at a time. Dense
+	// envelopes break a buffer up into lots of runs of a few positions each
+	// and evaluating all the lanes of a vector for each of those would cost
+	// more than it saves
+	static constexpr int MIN_VECTOR_RUN = 8;
+
+	template <bool Derivatives>
+	void calculate_short_run(
+		const FixedPositionVector& block_positions,
+		int beg,
+		int end,
+		blink_Position value,
+		blink_Position offset,
+		FixedPositionVector* out,
+		ml::DSPVector* derivatives) const
+	{
+		const auto distance = [&](int i)
+		{
+			return double(block_positions.values[i] - block_positions.values[beg]) * (1.0 / double(FixedPosition::ONE));
+		};
+
+		if (std::abs(1.0 - segment_.ratio) <= 0.0)
+		{
+			for (int i = beg + 1; i < end; i++)
+			{
+				out->set(i, (value + (distance(i) * segment_.ff0)) - offset);
+
+				if constexpr (Derivatives) derivatives->getBuffer()[i] = float(segment_.ff0);
+			}
+
+			return;
+		}
+
+		const blink_Position x = block_positions[beg];
+		const auto ff = segment_.ff0 * std::pow(segment_.ratio, x - segment_.x0);
+		const auto log_ratio = std::log(segment_.ratio);
+		const auto scale = ff / std::expm1(log_ratio);
+
+		for (int i = beg + 1; i < end; i++)
+		{
+			const auto exponent = distance(i) * log_ratio;
+
+			out->set(i, (value + (std::expm1(exponent) * scale)) - offset);
+
+			if constexpr (Derivatives) derivatives->getBuffer()[i] = float(std::exp(exponent) * ff);
+		}
+	}
+
 	blink_Position segment_start_ = 0.0f;
 	int point_search_index_ = 0;
+	Segment segment_;
 };
 
 class Classic
 {
 public:
 
+	//
+	// [Derivatives] selects at compile time whether derivatives are written.
+	// The other overloads pick the right version once per call depending on
+	// whether a derivatives pointer was passed
+	//
+	template <bool Derivatives>
+	void get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, FixedPositionVector* out, ml::DSPVector* derivatives);
+
+	void get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, FixedPositionVector* out, ml::DSPVector* derivatives = nullptr);
 	snd::transport::DSPVectorFramePosition get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, ml::DSPVector* derivatives = nullptr);
 
 private:
@@ -172,7 +373,8 @@ private:
 	ClassicCalculator calculator_;
 };
 
-inline snd::transport::DSPVectorFramePosition Classic::get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, ml::DSPVector* derivatives)
+template <bool Derivatives>
+inline void Classic::get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, FixedPositionVector* out, ml::DSPVector* derivatives)
 {
 	const auto& block_positions = traverser.block_positions();
 
@@ -180,26 +382,61 @@ inline snd::transport::DSPVectorFramePosition Classic::get_positions(float trans
 	{
 		const auto ff = math::convert::p_to_ff((env_pitch ? std::clamp(0.0f, env_pitch->min, env_pitch->max) : 0.0f) + transpose);
 
-		if (derivatives) *derivatives = ff;
+		if constexpr (Derivatives) *derivatives = ff;
 
-		return (block_positions.positions * ff) - float(sample_offset);
-	}
+		*out = (block_positions.fixed_positions * double(ff)) - sample_offset;
 
-	const auto& resets = traverser.get_resets();
+		return;
+	}
 
-	snd::transport::DSPVectorFramePosition out;
+	const auto has_resets = traverser.has_resets();
 
-	for (int i = 0; i < count; i++)
+	for (int i = 0; i < count;)
 	{
-		if (resets[i] > 0)
+		if (has_resets && traverser.is_reset(i))
 		{
 			calculator_.reset();
 		}
 
-		out.set(i, calculator_.calculate(transpose, env_pitch, block_positions.positions[i], derivatives ? &(derivatives->getBuffer()[i]) : nullptr) - sample_offset);
+		const auto value = calculator_.calculate<Derivatives>(transpose, env_pitch, block_positions.fixed_positions[i], Derivatives ? &(derivatives->getBuffer()[i]) : nullptr);
+
+		out->set(i, value - sample_offset);
+
+		//
+		// Positions which follow on in the same envelope segment are
+		// evaluated together
+		//
+		const auto& segment = calculator_.segment();
+		const auto run_end = traverser.get_run_end(i, count, segment.beg, segment.end);
+
+		if (run_end > i + 1)
+		{
+			calculator_.calculate_run<Derivatives>(block_positions.fixed_positions, i, run_end, value, sample_offset, out, derivatives);
+		}
+
+		i = run_end;
 	}
+}
+
+inline void Classic::get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, FixedPositionVector* out, ml::DSPVector* derivatives)
+{
+	if (derivatives)
+	{
+		get_positions<true>(transpose, env_pitch, traverser, sample_offset, count, out, derivatives);
+	}
+	else
+	{
+		get_positions<false>(transpose, env_pitch, traverser, sample_offset, count, out, nullptr);
+	}
+}
+
+inline snd::transport::DSPVectorFramePosition Classic::get_positions(float transpose, const blink_EnvelopeData* env_pitch, const Traverser& traverser, int sample_offset, int count, ml::DSPVector* derivatives)
+{
+	FixedPositionVector out;
+
+	get_positions(transpose, env_pitch, traverser, sample_offset, count, &out, derivatives);
 
-	return out;
+	return out.to_frame_positions();
 }
 
 }}
\ No newline at end of file
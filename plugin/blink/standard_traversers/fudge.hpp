@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
 #include <blink_sampler.h>
 #include "../traverser.hpp"
 #include "../envelope_parameter.hpp"
@@ -25,6 +26,28 @@ class FudgeCalculator
 {
 public:
 
+	// The envelope segment which was used for the last calculation. Within a
+	// segment the sample position is a quadratic function of the block
+	// position so any number of positions can be evaluated without searching
+	struct Segment
+	{
+		// Block position range covered by the segment
+		blink_Position beg = 0.0;
+		blink_Position end = 0.0;
+
+		// Block position of the segment start
+		blink_Position x0 = 0.0;
+
+		// Frequency factor at x0
+		double f0 = 1.0;
+
+		// Half of the change in frequency factor per block frame
+		double accel = 0.0;
+
+		// The envelope is at zero so the sample position doesn't move
+		bool frozen = false;
+	};
+
 	// We use this for both sample playback and waveform generation. This
 	// calculation needs to be fast, preferably O(n) or better.
 	//
@@ -38,7 +61,8 @@ public:
 	// the mathematics involved in calculating the resulting sample
 	// position.
 	//
-	float calculate(float speed, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative = nullptr)
+	template <bool Derivative>
+	blink_Position calculate(float speed, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative)
 	{
 		struct FFPoint
 		{
@@ -64,9 +88,16 @@ public:
 				{
 					point_search_index_ = 0;
 
-					if (derivative) *derivative = float(p1.ff);
+					segment_.beg = -std::numeric_limits<blink_Position>::infinity();
+					segment_.end = p1.x;
+					segment_.x0 = 0.0;
+					segment_.f0 = p1.ff;
+					segment_.accel = 0.0;
+					segment_.frozen = false;
+
+					if constexpr (Derivative) *derivative = float(p1.ff);
 
-					return float(spooky_maths(p1.ff, p1.ff, 1.0, block_position, double(segment_start_)));
+					return spooky_maths(p1.ff, p1.ff, 1.0, block_position, segment_start_);
 				}
 
 				FFPoint p0(envelope->points.points[i - 1], envelope->min, envelope->max, speed);
@@ -78,12 +109,19 @@ public:
 				{
 					point_search_index_ = i;
 
-					if (derivative) *derivative = float(math::lerp(p0.ff, p1.ff, n / segment_size));
+					if constexpr (Derivative) *derivative = float(math::lerp(p0.ff, p1.ff, n / segment_size));
 
 					const auto f0 = p0.ff;
 					const auto f1 = p1.ff;
 
-					return float(spooky_maths(f0, f1, segment_size, double(n), double(segment_start_)));
+					segment_.beg = p0.x;
+					segment_.end = p1.x;
+					segment_.x0 = p0.x;
+					segment_.f0 = f0;
+					segment_.accel = (f1 - f0) / (2.0 * segment_size);
+					segment_.frozen = false;
+
+					return spooky_maths(f0, f1, segment_size, double(n), segment_start_);
 				}
 			}
 			else
@@ -94,7 +132,7 @@ public:
 
 					const auto f1 = p1.ff;
 
-					segment_start_ = float(spooky_maths(f1, f1, 1.0, double(p1.x), double(segment_start_)));
+					segment_start_ = spooky_maths(f1, f1, 1.0, double(p1.x), segment_start_);
 				}
 				else
 				{
@@ -111,7 +149,7 @@ public:
 							auto f0 = p0.ff;
 							auto f1 = p1.ff;
 
-							segment_start_ = float(spooky_maths(f0, f1, segment_size, segment_size, double(segment_start_)));
+							segment_start_ = spooky_maths(f0, f1, segment_size, segment_size, segment_start_);
 						}
 					}
 				}
@@ -122,39 +160,133 @@ public:
 
 		auto n = block_position - p0.x;
 
-		if (derivative) *derivative = float(p0.ff);
+		segment_.beg = p0.x;
+		segment_.end = std::numeric_limits<blink_Position>::infinity();
+		segment_.x0 = p0.x;
+		segment_.f0 = p0.ff;
+		segment_.accel = 0.0;
+		segment_.frozen = p0.y == 0.0f;
+
+		if constexpr (Derivative) *derivative = float(p0.ff);
 
 		if (p0.y == 0.0f)
 		{
 			return segment_start_;
 		}
 
-		return float(spooky_maths(p0.ff, p0.ff, 1.0, double(n), double(segment_start_)));
+		return spooky_maths(p0.ff, p0.ff, 1.0, double(n), segment_start_);
+	}
+
+	blink_Position calculate(float speed, const blink_EnvelopeData* envelope, blink_Position block_position, float* derivative = nullptr)
+	{
+		return derivative
+			? calculate<true>(speed, envelope, block_position, derivative)
+			: calculate<false>(speed, envelope, block_position, nullptr);
+	}
+
+	//
+	// Evaluates block positions [beg + 1, end) which must all lie inside the
+	// segment used by the last call to calculate(). That call was for block
+	// position [beg] and returned [value].
+	//
+	// The calculator state is left exactly as if calculate() had been called
+	// for each position.
+	//
+	template <bool Derivatives>
+	void calculate_run(
+		const FixedPositionVector& block_positions,
+		int beg,
+		int end,
+		blink_Position value,
+		FixedPositionVector* out,
+		ml::DSPVector* derivatives) const
+	{
+		const blink_Position x = block_positions[beg];
+
+		const auto ff = segment_.f0 + (2.0 * segment_.accel * (x - segment_.x0));
+
+		if (end - beg < MIN_VECTOR_RUN)
+		{
+			const auto velocity = segment_.frozen ? 0.0 : ff;
+
+			for (int i = beg + 1; i < end; i++)
+			{
+				const auto distance = double(block_positions.values[i] - block_positions.values[beg]) * (1.0 / double(FixedPosition::ONE));
+
+				out->set(i, value + (distance * (velocity + (distance * segment_.accel))));
+
+				if constexpr (Derivatives) derivatives->getBuffer()[i] = float(ff + (distance * (2.0 * segment_.accel)));
+			}
+
+			return;
+		}
+
+		ml::DSPVector distance(0.0f);
+
+		for (int i = beg + 1; i < end; i++)
+		{
+			distance[i] = float(double(block_positions.values[i] - block_positions.values[beg]) * (1.0 / double(FixedPosition::ONE)));
+		}
+
+		const auto velocity = segment_.frozen ? 0.0f : float(ff);
+		const auto accel = float(segment_.accel);
+
+		const auto delta = distance * (velocity + (distance * accel));
+
+		for (int i = beg + 1; i < end; i++)
+		{
+			out->set(i, value + delta[i]);
+		}
+
+		if constexpr (Derivatives)
+		{
+			const auto run_derivatives = float(ff) + (distance * (2.0f * accel));
+
+			for (int i = beg + 1; i < end; i++)
+			{
+				derivatives->getBuffer()[i] = run_derivatives[i];
+			}
+		}
 	}
 
+	const Segment& segment() const { return segment_; }
+
 	void reset()
 	{
-		segment_start_ = 0.0f;
+		segment_start_ = 0.0;
 		point_search_index_ = 0;
 	}
 
 private:
 
-	float segment_start_ = 0.0f;
+	// Runs shorter than this are evaluated one position at a time rather
+	// than across a whole vector (see ClassicCalculator)
+	static constexpr int MIN_VECTOR_RUN = 8;
+
+	blink_Position segment_start_ = 0.0;
 	int point_search_index_ = 0;
+	Segment segment_;
 };
 
 class WarpCalculator
 {
 public:
 
-	float calculate(const blink_WarpPoints* warp_points, float sculpted_position, float* derivative = nullptr)
+	blink_Position calculate(const blink_WarpPoints* warp_points, blink_Position sculpted_position, float* derivative = nullptr)
+	{
+		return derivative
+			? calculate<true>(warp_points, sculpted_position, derivative)
+			: calculate<false>(warp_points, sculpted_position, nullptr);
+	}
+
+	template <bool Derivative>
+	blink_Position calculate(const blink_WarpPoints* warp_points, blink_Position sculpted_position, float* derivative)
 	{
 		if (warp_points->count == 1)
 		{
-			if (derivative) *derivative = 1.0f;
+			if constexpr (Derivative) *derivative = 1.0f;
 
-			return sculpted_position - float(warp_points->points[0].y - warp_points->points[0].x);
+			return sculpted_position - blink_Position(warp_points->points[0].y - warp_points->points[0].x);
 		}
 
 		for (blink_Index i = point_search_index_; i < warp_points->count; i++)
@@ -167,9 +299,7 @@ public:
 			{
 				if (i == 0)
 				{
-					auto x = sculpted_position / p1.y;
-
-					if (derivative) *derivative = 1.0f;
+					if constexpr (Derivative) *derivative = 1.0f;
 
 					return p1.x + (sculpted_position - p1.y);
 				}
@@ -178,11 +308,11 @@ public:
 
 				auto segment_size = p1.y - p0.y;
 
-				if (segment_size > 0.f)
+				if (segment_size > 0)
 				{
 					auto x = (sculpted_position - p0.y) / segment_size;
 
-					if (derivative)
+					if constexpr (Derivative)
 					{
 						const auto x_diff = (p1.x - p0.x);
 						const auto y_diff = (p1.y - p0.y);
@@ -191,7 +321,7 @@ public:
 						else *derivative = float(x_diff) / y_diff;
 					}
 
-					return math::lerp(float(p0.x), float(p1.x), float(x));
+					return math::lerp(blink_Position(p0.x), blink_Position(p1.x), x);
 				}
 			}
 		}
@@ -200,7 +330,7 @@ public:
 
 		point_search_index_ = warp_points->count;
 
-		if (derivative) *derivative = 1.0f;
+		if constexpr (Derivative) *derivative = 1.0f;
 
 		return p0.x + (sculpted_position - p0.y);
 	}
@@ -219,6 +349,45 @@ class Fudge
 {
 public:
 
+	// Output flags for get_positions()
+	enum Outputs
+	{
+		Outputs_SculptedPositions = 1 << 0,
+		Outputs_WarpedPositions   = 1 << 1,
+		Outputs_Derivatives       = 1 << 2,
+	};
+
+	//
+	// [OutputFlags] selects at compile time which outputs are calculated. The
+	// warp stage is skipped entirely unless warped positions or derivatives
+	// are requested.
+	//
+	// The overloads without [OutputFlags] pick the right version once per
+	// call depending on which output pointers are non-null
+	//
+	template <int OutputFlags>
+	void get_positions(
+		float speed,
+		const blink_EnvelopeData* env_speed,
+		const blink_WarpPoints* warp_points,
+		const Traverser& traverser,
+		int sample_offset,
+		int count,
+		FixedPositionVector* sculpted_positions,
+		FixedPositionVector* warped_positions,
+		ml::DSPVector* derivatives);
+
+	void get_positions(
+		float speed,
+		const blink_EnvelopeData* env_speed,
+		const blink_WarpPoints* warp_points,
+		const Traverser& traverser,
+		int sample_offset,
+		int count,
+		FixedPositionVector* sculpted_positions,
+		FixedPositionVector* warped_positions,
+		ml::DSPVector* derivatives = nullptr);
+
 	void get_positions(
 		float speed,
 		const blink_EnvelopeData* env_speed,
@@ -232,33 +401,40 @@ public:
 
 private:
 	
+	template <bool Derivatives>
 	void get_sculpted_positions(
 		float speed,
 		const blink_EnvelopeData* env_speed,
 		const Traverser& traverser,
 		int count,
-		snd::transport::DSPVectorFramePosition* positions,
-		ml::DSPVector* derivatives = nullptr);
+		FixedPositionVector* positions,
+		ml::DSPVector* derivatives);
 
+	template <bool Derivatives>
 	void get_warp_positions(
 		const blink_WarpPoints* warp_points,
 		const Traverser& traverser,
 		int count,
-		snd::transport::DSPVectorFramePosition* positions,
-		ml::DSPVector* derivatives = nullptr);
+		FixedPositionVector* positions,
+		ml::DSPVector* derivatives);
 
 	FudgeCalculator calculator_;
 	BlockPositions sculpted_block_positions_;
 	Traverser warp_traverser_;
 	WarpCalculator warp_calculator_;
+
+	// Set when the warp stage was skipped so the warp calculator has to
+	// search from the start next time
+	bool warp_stale_ = false;
 };
 
+template <bool Derivatives>
 inline void Fudge::get_sculpted_positions(
 	float speed,
 	const blink_EnvelopeData* env_speed,
 	const Traverser& traverser,
 	int count,
-	snd::transport::DSPVectorFramePosition *positions,
+	FixedPositionVector* positions,
 	ml::DSPVector* derivatives)
 {
 	const auto& block_positions = traverser.block_positions();
@@ -267,57 +443,75 @@ inline void Fudge::get_sculpted_positions(
 	{
 		const auto ff = (env_speed ? std::clamp(1.0f, env_speed->min, env_speed->max) : 1.0f) * speed;
 
-		*positions = block_positions.positions * ff;
+		*positions = block_positions.fixed_positions * double(ff);
 
-		if (derivatives) *derivatives = ff;
+		if constexpr (Derivatives) *derivatives = ff;
 
 		return;
 	}
 
-	const auto& resets = traverser.get_resets();
+	const auto has_resets = traverser.has_resets();
 
-	for (int i = 0; i < count; i++)
+	for (int i = 0; i < count;)
 	{
-		if (resets[i] > 0)
+		if (has_resets && traverser.is_reset(i))
 		{
 			calculator_.reset();
 		}
 
-		positions->set(i, calculator_.calculate(speed, env_speed, block_positions.positions[i], derivatives ? &(derivatives->getBuffer()[i]) : nullptr));
+		const auto value = calculator_.calculate<Derivatives>(speed, env_speed, block_positions.fixed_positions[i], Derivatives ? &(derivatives->getBuffer()[i]) : nullptr);
+
+		positions->set(i, value);
+
+		//
+		// Positions which follow on in the same envelope segment are
+		// evaluated together
+		//
+		const auto& segment = calculator_.segment();
+		const auto run_end = traverser.get_run_end(i, count, segment.beg, segment.end);
+
+		if (run_end > i + 1)
+		{
+			calculator_.calculate_run<Derivatives>(block_positions.fixed_positions, i, run_end, value, positions, derivatives);
+		}
+
+		i = run_end;
 	}
 }
 
+template <bool Derivatives>
 inline void Fudge::get_warp_positions(
 	const blink_WarpPoints* warp_points,
 	const Traverser& traverser,
 	int count,
-	snd::transport::DSPVectorFramePosition* positions,
+	FixedPositionVector* positions,
 	ml::DSPVector* derivatives)
 {
 	const auto& block_positions = traverser.block_positions();
 
 	if (!warp_points || warp_points->count < 1)
 	{
-		*positions = block_positions.positions;
+		*positions = block_positions.fixed_positions;
 
-		if (derivatives) *derivatives = 1.0f;
+		if constexpr (Derivatives) *derivatives = 1.0f;
 
 		return;
 	}
 
-	const auto& resets = traverser.get_resets();
+	const auto has_resets = traverser.has_resets();
 
 	for (int i = 0; i < count; i++)
 	{
-		if (resets[i] > 0)
+		if (has_resets && traverser.is_reset(i))
 		{
 			warp_calculator_.reset();
 		}
 
-		positions->set(i, warp_calculator_.calculate(warp_points, block_positions.positions[i], derivatives ? &(derivatives->getBuffer()[i]) : nullptr));
+		positions->set(i, warp_calculator_.calculate<Derivatives>(warp_points, block_positions.fixed_positions[i], Derivatives ? &(derivatives->getBuffer()[i]) : nullptr));
 	}
 }
 
+template <int OutputFlags>
 inline void Fudge::get_positions(
 	float speed,
 	const blink_EnvelopeData* env_speed,
@@ -325,28 +519,148 @@ inline void Fudge::get_positions(
 	const Traverser& traverser,
 	int sample_offset,
 	int count,
-	snd::transport::DSPVectorFramePosition* out_sculpted_positions,
-	snd::transport::DSPVectorFramePosition* out_warped_positions,
+	FixedPositionVector* out_sculpted_positions,
+	FixedPositionVector* out_warped_positions,
 	ml::DSPVector* out_derivatives)
 {
-	snd::transport::DSPVectorFramePosition sculpted_positions;
-	snd::transport::DSPVectorFramePosition warped_positions;
+	constexpr auto SCULPTED = (OutputFlags & Outputs_SculptedPositions) != 0;
+	constexpr auto WARPED = (OutputFlags & Outputs_WarpedPositions) != 0;
+	constexpr auto DERIVATIVES = (OutputFlags & Outputs_Derivatives) != 0;
+
+	FixedPositionVector sculpted_positions;
 	ml::DSPVector sculpted_derivatives;
-	ml::DSPVector warped_derivatives;
 
-	get_sculpted_positions(speed, env_speed, traverser, count, &sculpted_positions, out_derivatives ? &sculpted_derivatives : nullptr);
+	get_sculpted_positions<DERIVATIVES>(speed, env_speed, traverser, count, &sculpted_positions, &sculpted_derivatives);
 
 	sculpted_positions -= sample_offset;
 
-	sculpted_block_positions_(sculpted_positions, 0, count);
+	if constexpr (SCULPTED) *out_sculpted_positions = sculpted_positions;
+
+	if constexpr (WARPED || DERIVATIVES)
+	{
+		FixedPositionVector warped_positions;
+		ml::DSPVector warped_derivatives;
+
+		sculpted_block_positions_(sculpted_positions, 0, count);
+
+		warp_traverser_.generate(sculpted_block_positions_, count);
+
+		if (warp_stale_)
+		{
+			warp_traverser_.set_reset(0);
+			warp_stale_ = false;
+		}
+
+		get_warp_positions<DERIVATIVES>(warp_points, warp_traverser_, count, &warped_positions, &warped_derivatives);
+
+		if constexpr (WARPED) *out_warped_positions = warped_positions;
+		if constexpr (DERIVATIVES) *out_derivatives = sculpted_derivatives * warped_derivatives;
+	}
+	else
+	{
+		warp_stale_ = true;
+	}
+}
+
+inline void Fudge::get_positions(
+	float speed,
+	const blink_EnvelopeData* env_speed,
+	const blink_WarpPoints* warp_points,
+	const Traverser& traverser,
+	int sample_offset,
+	int count,
+	FixedPositionVector* out_sculpted_positions,
+	FixedPositionVector* out_warped_positions,
+	ml::DSPVector* out_derivatives)
+{
+	const auto flags =
+		(out_sculpted_positions ? Outputs_SculptedPositions : 0) |
+		(out_warped_positions ? Outputs_WarpedPositions : 0) |
+		(out_derivatives ? Outputs_Derivatives : 0);
+
+	const auto sculpted = out_sculpted_positions;
+	const auto warped = out_warped_positions;
+	const auto derivatives = out_derivatives;
 
-	warp_traverser_.generate(sculpted_block_positions_, count);
+	switch (flags)
+	{
+		case 0:
+		{
+			get_positions<0>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+
+		case Outputs_SculptedPositions:
+		{
+			get_positions<Outputs_SculptedPositions>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+
+		case Outputs_WarpedPositions:
+		{
+			get_positions<Outputs_WarpedPositions>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+
+		case Outputs_Derivatives:
+		{
+			get_positions<Outputs_Derivatives>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+
+		case Outputs_SculptedPositions | Outputs_WarpedPositions:
+		{
+			get_positions<Outputs_SculptedPositions | Outputs_WarpedPositions>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+
+		case Outputs_SculptedPositions | Outputs_Derivatives:
+		{
+			get_positions<Outputs_SculptedPositions | Outputs_Derivatives>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
 
-	get_warp_positions(warp_points, warp_traverser_, count, &warped_positions, out_derivatives ? &warped_derivatives : nullptr);
+		case Outputs_WarpedPositions | Outputs_Derivatives:
+		{
+			get_positions<Outputs_WarpedPositions | Outputs_Derivatives>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
 
-	if (out_sculpted_positions) *out_sculpted_positions = sculpted_positions;
-	if (out_warped_positions) *out_warped_positions = warped_positions;
-	if (out_derivatives) *out_derivatives = sculpted_derivatives * warped_derivatives;
+		default:
+		{
+			get_positions<Outputs_SculptedPositions | Outputs_WarpedPositions | Outputs_Derivatives>(speed, env_speed, warp_points, traverser, sample_offset, count, sculpted, warped, derivatives);
+			break;
+		}
+	}
+}
+
+inline void Fudge::get_positions(
+	float speed,
+	const blink_EnvelopeData* env_speed,
+	const blink_WarpPoints* warp_points,
+	const Traverser& traverser,
+	int sample_offset,
+	int count,
+	snd::transport::DSPVectorFramePosition* out_sculpted_positions,
+	snd::transport::DSPVectorFramePosition* out_warped_positions,
+	ml::DSPVector* out_derivatives)
+{
+	FixedPositionVector sculpted_positions;
+	FixedPositionVector warped_positions;
+
+	get_positions(
+		speed,
+		env_speed,
+		warp_points,
+		traverser,
+		sample_offset,
+		count,
+		out_sculpted_positions ? &sculpted_positions : nullptr,
+		out_warped_positions ? &warped_positions : nullptr,
+		out_derivatives);
+
+	if (out_sculpted_positions) *out_sculpted_positions = sculpted_positions.to_frame_positions();
+	if (out_warped_positions) *out_warped_positions = warped_positions.to_frame_positions();
 }
 
 }}
\ No newline at end of file
@@ -1,8 +1,8 @@
 #pragma once
 
-#include <set>
 #include <blink/plugin.hpp>
 #include <blink/synth_instance.hpp>
+#include <blink/synth_voices.hpp>
 
 namespace blink {
 
@@ -15,18 +15,40 @@ public:
 	SynthInstance* add_instance();
 	void destroy_instance(SynthInstance* instance);
 
+	//
+	// For implementing blink_synth_process_batch().
+	//
+	// If voice processing is enabled, consecutive jobs from the same instance
+	// group are gathered into groups of up to SIMD_LANES units and passed to
+	// process_voices() together. Otherwise each unit is processed on its own
+	//
+	blink_Error process_batch(blink_SynthJob* jobs, blink_Index count);
+
+protected:
+
+	void enable_voice_processing(bool enable) { voice_processing_ = enable; }
+
 private:
 
 	virtual SynthInstance* make_instance() = 0;
 
-	std::set<SynthInstance*> instances_;
+	//
+	// Override this and call enable_voice_processing() to process voices
+	// across SIMD lanes. It must call voices.write() exactly once, unless it
+	// fails, in which case the voices are silenced
+	//
+	virtual blink_Error process_voices(SynthVoices<>&) { return blink_StdError_NotImplemented; }
+
+	blink_Error flush_voices(blink_SynthJob* jobs, blink_Index beg, blink_Index end);
+
+	bool voice_processing_ = false;
 };
 
 inline SynthPlugin::~SynthPlugin()
 {
-	for (auto instance : instances_)
+	while (const auto instance = first_instance())
 	{
-		delete instance;
+		destroy_instance(static_cast<SynthInstance*>(instance));
 	}
 }
 
@@ -34,7 +56,6 @@ inline SynthInstance* SynthPlugin::add_instance()
 {
 	const auto instance = make_instance();
 
-	instances_.insert(instance);
 	register_instance(instance);
 
 	return instance;
@@ -42,9 +63,83 @@ inline SynthInstance* SynthPlugin::add_instance()
 
 inline void SynthPlugin::destroy_instance(SynthInstance* instance)
 {
-	instances_.erase(instance);
 	unregister_instance(instance);
 	delete instance;
 }
 
+inline blink_Error SynthPlugin::process_batch(blink_SynthJob* jobs, blink_Index count)
+{
+	if (!voice_processing_)
+	{
+		return SynthUnit::process_batch(jobs, count);
+	}
+
+	blink_Error out = BLINK_OK;
+	blink_Index group_beg = 0;
+
+	for (blink_Index i = 0; i <= count; i++)
+	{
+		const auto group_ended =
+			i == count ||
+			i - group_beg >= blink_Index(SIMD_LANES) ||
+			jobs[i].buffer->instance_group != jobs[group_beg].buffer->instance_group;
+
+		if (!group_ended) continue;
+
+		if (i > group_beg)
+		{
+			const auto result = flush_voices(jobs, group_beg, i);
+
+			if (result != BLINK_OK && out == BLINK_OK)
+			{
+				out = result;
+			}
+		}
+
+		group_beg = i;
+	}
+
+	return out;
+}
+
+inline blink_Error SynthPlugin::flush_voices(blink_SynthJob* jobs, blink_Index beg, blink_Index end)
+{
+	SynthVoices<> voices;
+
+	blink_Error out = BLINK_OK;
+
+	for (auto i = beg; i < end; i++)
+	{
+		const auto unit = (SynthUnit*)(jobs[i].proc_data);
+
+		if (!unit->is_active())
+		{
+			jobs[i].result = blink_StdError_UnitInactive;
+			out = blink_StdError_UnitInactive;
+			continue;
+		}
+
+		jobs[i].result = BLINK_OK;
+
+		voices.add(unit, jobs[i].buffer, jobs[i].out);
+	}
+
+	if (voices.count() == 0) return out;
+
+	const auto result = process_voices(voices);
+
+	// Makes sure every unit is finished even if process_voices() bailed out
+	// before writing
+	voices.finish();
+
+	if (result == BLINK_OK) return out;
+
+	for (auto i = beg; i < end; i++)
+	{
+		if (jobs[i].result == BLINK_OK) jobs[i].result = result;
+	}
+
+	return result;
+}
+
 } // tract
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 namespace blink {
 
+template <int LANES> class SynthVoices;
+
 class SynthUnit : public Unit
 {
 public:
@@ -20,16 +22,104 @@ public:
 
 	blink_Error synth_process(const blink_SynthBuffer* buffer, float* out)
 	{
-		get_instance()->begin_process(buffer->buffer_id);
+		if (!is_active()) return blink_StdError_UnitInactive;
 
-		Unit::begin_process(buffer->buffer_id, buffer->positions, buffer->data_offset);
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("synth_process", this, buffer->buffer_id);
+
+		begin_voice(buffer);
+
+		const auto result = process(buffer, out);
+
+		end_voice(out);
 
-		return process(buffer, out);
+		return result;
+	}
+
+	//
+	// For implementing blink_synth_process_batch(). Units are processed back to
+	// back without going through the function pointers
+	//
+	static blink_Error process_batch(blink_SynthJob* jobs, blink_Index count)
+	{
+		blink_Error out = BLINK_OK;
+
+		for (blink_Index i = 0; i < count; i++)
+		{
+			auto& job = jobs[i];
+			auto unit = (SynthUnit*)(job.proc_data);
+
+			job.result = unit->synth_process(job.buffer, job.out);
+
+			if (job.result != BLINK_OK && out == BLINK_OK)
+			{
+				out = job.result;
+			}
+		}
+
+		return out;
+	}
+
+	blink_Error synth_process_vectors(const blink_SynthBuffer* buffer, blink_Index num_vectors, float* out)
+	{
+		if (num_vectors < 1) return blink_StdError_InvalidArgument;
+		if (!is_active()) return blink_StdError_UnitInactive;
+
+		profile::CallScope profile_scope(profile());
+		trace::Scope trace_scope("synth_process_vectors", this, buffer->buffer_id);
+
+		get_instance()->begin_process(buffer->buffer_id, int(num_vectors));
+
+		Unit::begin_process(buffer->buffer_id, int(num_vectors));
+
+		auto vector_buffer = *buffer;
+
+		for (blink_Index i = 0; i < num_vectors; i++)
+		{
+			vector_buffer.buffer_id = buffer->buffer_id + i;
+			vector_buffer.positions = buffer->positions + (i * BLINK_VECTOR_SIZE);
+
+			Unit::set_positions(vector_buffer.positions, buffer->data_offset);
+
+			update_parameter_changes();
+
+			const auto vector_out = out + (i * BLINK_VECTOR_SIZE * 2);
+
+			begin_vector();
+
+			const auto result = process(&vector_buffer, vector_out);
+
+			end_vector(vector_out, int(i));
+
+			if (result != BLINK_OK) return result;
+		}
+
+		return BLINK_OK;
 	}
 
 private:
 
+	template <int LANES> friend class SynthVoices;
+
 	virtual blink_Error process(const blink_SynthBuffer* buffer, float* out) = 0;
+
+	// Everything which happens around process() for a single vector. Split
+	// out so that SynthVoices can process several units at once
+	void begin_voice(const blink_SynthBuffer* buffer)
+	{
+		get_instance()->begin_process(buffer->buffer_id);
+
+		Unit::begin_process(buffer->buffer_id, buffer->positions, buffer->data_offset);
+
+		update_parameter_changes();
+
+		begin_vector();
+	}
+
+	void end_voice(const float* out)
+	{
+		end_vector(out, 0);
+	}
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <blink_synth.h>
+#include "envelope_parameter.hpp"
+#include "synth_unit.hpp"
+
+#pragma warning(push, 0)
+#include <DSP/MLDSPOps.h>
+#pragma warning(pop)
+
+namespace blink {
+
+#if defined(__AVX__)
+constexpr int SIMD_LANES = 8;
+#else
+constexpr int SIMD_LANES = 4;
+#endif
+
+//
+// One vector of frames for up to [LANES] voices, laid out so that each
+// frame's values for all of the voices sit next to each other. Loops over
+// the lanes of a frame compile down to a single SIMD operation, so voice
+// DSP written against this scales with the lane count rather than the
+// number of voices
+//
+template <int LANES = SIMD_LANES>
+struct alignas(LANES * sizeof(float)) VoiceVector
+{
+	float frames[kFloatsPerDSPVector][LANES];
+
+	VoiceVector(float value = 0.0f)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			for (int lane = 0; lane < LANES; lane++) frames[i][lane] = value;
+		}
+	}
+
+	void set_lane(int lane, const float* in)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++) frames[i][lane] = in[i];
+	}
+
+	void get_lane(int lane, float* out) const
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++) out[i] = frames[i][lane];
+	}
+
+	VoiceVector& operator+=(const VoiceVector& rhs)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			for (int lane = 0; lane < LANES; lane++) frames[i][lane] += rhs.frames[i][lane];
+		}
+
+		return *this;
+	}
+
+	VoiceVector& operator*=(const VoiceVector& rhs)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			for (int lane = 0; lane < LANES; lane++) frames[i][lane] *= rhs.frames[i][lane];
+		}
+
+		return *this;
+	}
+
+	VoiceVector& operator*=(float rhs)
+	{
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			for (int lane = 0; lane < LANES; lane++) frames[i][lane] *= rhs;
+		}
+
+		return *this;
+	}
+};
+
+//
+// A group of synth units from the same instance group which are processed
+// together, one voice per lane (see SynthPlugin::process_batch()). Each
+// batch call builds its own on the stack so that batches can run on
+// several threads at once. The time spent processing the group is shared
+// out between the units' profiles
+//
+template <int LANES = SIMD_LANES>
+class SynthVoices
+{
+public:
+
+	void clear()
+	{
+		count_ = 0;
+		written_ = false;
+	}
+
+	void add(SynthUnit* unit, const blink_SynthBuffer* buffer, float* out)
+	{
+		unit->begin_voice(buffer);
+
+		profile_scope_.add(unit->profile());
+
+		units_[count_] = unit;
+		buffers_[count_] = buffer;
+		outs_[count_] = out;
+
+		count_++;
+	}
+
+	bool full() const { return count_ >= LANES; }
+
+	int count() const { return count_; }
+	SynthUnit* unit(int lane) const { return units_[lane]; }
+	const blink_SynthBuffer* buffer(int lane) const { return buffers_[lane]; }
+
+	// Block positions of every voice. Unused lanes are zero
+	VoiceVector<LANES> positions() const;
+
+	//
+	// Evaluates the envelope for every voice. Each voice is searched with its
+	// own block positions and parameter data and the results are
+	// interleaved into lanes
+	//
+	VoiceVector<LANES> search(const EnvelopeParameter& envelope, int parameter_index) const;
+
+	// Writes each voice's lanes into its unit's output and finishes
+	// processing the unit
+	void write(const VoiceVector<LANES>& L, const VoiceVector<LANES>& R);
+
+	// If write() hasn't been called, writes silence to every voice and
+	// finishes processing the units so that none of them are left half way
+	// through a vector
+	void finish();
+
+private:
+
+	profile::GroupScope<LANES> profile_scope_;
+	int count_ = 0;
+	bool written_ = false;
+	SynthUnit* units_[LANES];
+	const blink_SynthBuffer* buffers_[LANES];
+	float* outs_[LANES];
+};
+
+template <int LANES>
+inline VoiceVector<LANES> SynthVoices<LANES>::positions() const
+{
+	VoiceVector<LANES> out;
+
+	for (int lane = 0; lane < count_; lane++)
+	{
+		const auto& block_positions = units_[lane]->block_positions();
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			out.frames[i][lane] = float(block_positions.fixed_positions[i]);
+		}
+	}
+
+	return out;
+}
+
+template <int LANES>
+inline VoiceVector<LANES> SynthVoices<LANES>::search(const EnvelopeParameter& envelope, int parameter_index) const
+{
+	VoiceVector<LANES> out;
+
+	for (int lane = 0; lane < count_; lane++)
+	{
+		const auto data = Plugin::get_envelope_data(buffers_[lane]->parameter_data, parameter_index);
+
+		ml::DSPVector lane_values;
+
+		envelope.search_vec(data, units_[lane]->block_positions(), lane_values.getBuffer());
+
+		out.set_lane(lane, lane_values.getConstBuffer());
+	}
+
+	return out;
+}
+
+template <int LANES>
+inline void SynthVoices<LANES>::write(const VoiceVector<LANES>& L, const VoiceVector<LANES>& R)
+{
+	for (int lane = 0; lane < count_; lane++)
+	{
+		L.get_lane(lane, outs_[lane]);
+		R.get_lane(lane, outs_[lane] + kFloatsPerDSPVector);
+
+		units_[lane]->end_voice(outs_[lane]);
+	}
+
+	written_ = true;
+}
+
+template <int LANES>
+inline void SynthVoices<LANES>::finish()
+{
+	if (written_) return;
+
+	const VoiceVector<LANES> silence;
+
+	write(silence, silence);
+}
+
+}
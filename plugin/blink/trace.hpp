@@ -0,0 +1,330 @@
+#pragma once
+
+#include <cstdint>
+#include <blink.h>
+
+//
+// Opt-in timeline tracing. Define BLINK_TRACE when building the plugin to
+// enable it. Otherwise everything in here compiles away to nothing.
+//
+// Events are written into one fixed-size lock-free buffer shared by every
+// thread. Any number of audio threads can record at once; a single
+// non-audio thread drains the buffer with flush() and appends the events to
+// a Chrome trace JSON file. If the buffer fills up because nobody is
+// flushing, new events are dropped and counted rather than blocking.
+//
+// Event names must be string literals (only the pointer is stored).
+//
+// For implementing the blink_trace_*() exports:
+//
+//	blink_Error blink_trace_begin(const char* path) { return blink::trace::begin(path); }
+//	blink_Error blink_trace_flush() { return blink::trace::flush(); }
+//	blink_Error blink_trace_end() { return blink::trace::end(); }
+//
+
+#ifdef BLINK_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace blink {
+namespace trace {
+
+struct Event
+{
+	const char* name = nullptr;
+	const void* object = nullptr;
+	std::uint64_t time = 0;
+	std::uint64_t arg = 0;
+	std::size_t thread = 0;
+	float value = 0.0f;
+	char phase = 0;
+};
+
+namespace detail {
+
+inline std::uint64_t now()
+{
+	return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Not a thread_local counter because the first access to a thread_local
+// from a dlopen'd plugin can allocate. The writer maps these to small
+// numbers
+inline std::size_t thread_id()
+{
+	return std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+//
+// Slots are claimed in order by bumping write_. A slot's sequence number is
+// set to its index + 1 once the event in it is complete, so the reader
+// never sees a half written event even if the writers finish out of order
+//
+class Buffer
+{
+public:
+
+	static constexpr std::uint64_t CAPACITY = 1 << 16;
+
+	bool recording() const { return recording_.load(std::memory_order_relaxed); }
+	void set_recording(bool recording) { recording_.store(recording, std::memory_order_release); }
+
+	// Audio thread
+	void push(const Event& event)
+	{
+		auto write = write_.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			if (write - read_.load(std::memory_order_acquire) >= CAPACITY)
+			{
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			if (write_.compare_exchange_weak(write, write + 1, std::memory_order_relaxed)) break;
+		}
+
+		auto& slot = slots_[write % CAPACITY];
+
+		slot.event = event;
+		slot.sequence.store(write + 1, std::memory_order_release);
+	}
+
+	// Flushing thread. Calls [fn] for every complete event, in order
+	template <class Fn>
+	void drain(Fn&& fn)
+	{
+		auto read = read_.load(std::memory_order_relaxed);
+
+		for (;; read++)
+		{
+			const auto& slot = slots_[read % CAPACITY];
+
+			if (slot.sequence.load(std::memory_order_acquire) != read + 1) break;
+
+			fn(slot.event);
+		}
+
+		read_.store(read, std::memory_order_release);
+	}
+
+	std::uint64_t take_dropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+private:
+
+	struct Slot
+	{
+		Event event;
+		std::atomic<std::uint64_t> sequence { 0 };
+	};
+
+	Slot slots_[CAPACITY];
+	alignas(64) std::atomic<std::uint64_t> write_ { 0 };
+	alignas(64) std::atomic<std::uint64_t> read_ { 0 };
+	std::atomic<std::uint64_t> dropped_ { 0 };
+	std::atomic<bool> recording_ { false };
+};
+
+inline Buffer& buffer()
+{
+	static Buffer buffer;
+
+	return buffer;
+}
+
+inline void record(const char* name, char phase, const void* object, std::uint64_t arg, float value = 0.0f)
+{
+	auto& b = buffer();
+
+	if (!b.recording()) return;
+
+	b.push({ name, object, now(), arg, thread_id(), value, phase });
+}
+
+//
+// Everything below here only runs on the flushing thread
+//
+struct Session
+{
+	std::mutex mutex;
+	std::map<std::size_t, unsigned> threads;
+	std::FILE* file = nullptr;
+	std::uint64_t start_time = 0;
+	std::uint64_t num_dropped = 0;
+	bool first_event = true;
+};
+
+inline Session& session()
+{
+	static Session session;
+
+	return session;
+}
+
+inline void write(Session& s, const Event& event)
+{
+	const auto ts = double(event.time > s.start_time ? event.time - s.start_time : 0) / 1000.0;
+	const auto thread = s.threads.emplace(event.thread, unsigned(s.threads.size()) + 1).first->second;
+
+	std::fprintf(s.file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+		s.first_event ? "" : ",", event.name, event.phase, ts, thread);
+
+	s.first_event = false;
+
+	switch (event.phase)
+	{
+		case 'B':
+		{
+			std::fprintf(s.file, ",\"args\":{\"object\":\"%p\",\"buffer\":%llu}}", event.object, (unsigned long long)(event.arg));
+			break;
+		}
+
+		case 'C':
+		{
+			std::fprintf(s.file, ",\"id\":%llu,\"args\":{\"value\":%g}}", (unsigned long long)(event.arg), double(event.value));
+			break;
+		}
+
+		default:
+		{
+			std::fprintf(s.file, "}");
+			break;
+		}
+	}
+}
+
+inline void flush(Session& s)
+{
+	buffer().drain([&s](const Event& event) { write(s, event); });
+
+	s.num_dropped += buffer().take_dropped();
+
+	std::fflush(s.file);
+}
+
+}
+
+//
+// Records a begin event now and the matching end event when it goes out
+// of scope. [object] is the unit or instance and [arg] is usually the
+// buffer ID
+//
+class Scope
+{
+public:
+
+	Scope(const char* name, const void* object, std::uint64_t arg)
+		: name_(name)
+	{
+		detail::record(name, 'B', object, arg);
+	}
+
+	~Scope()
+	{
+		detail::record(name_, 'E', nullptr, 0);
+	}
+
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+
+private:
+
+	const char* name_;
+};
+
+// A value plotted over time. Events with the same name and [id] form one
+// counter track, e.g. one per sample for preprocessing progress
+inline void counter(const char* name, std::uint64_t id, float value)
+{
+	detail::record(name, 'C', nullptr, id, value);
+}
+
+inline blink_Error begin(const char* path)
+{
+	auto& s = detail::session();
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+
+	if (s.file) return blink_StdError_AlreadyInitialized;
+
+	s.file = std::fopen(path, "w");
+
+	if (!s.file) return blink_StdError_FileError;
+
+	// Throw away anything left over from a previous session
+	detail::buffer().drain([](const Event&) {});
+	detail::buffer().take_dropped();
+
+	s.threads.clear();
+	s.start_time = detail::now();
+	s.num_dropped = 0;
+	s.first_event = true;
+
+	std::fprintf(s.file, "{\"traceEvents\":[");
+
+	detail::buffer().set_recording(true);
+
+	return BLINK_OK;
+}
+
+inline blink_Error flush()
+{
+	auto& s = detail::session();
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+
+	if (!s.file) return blink_StdError_NotInitialized;
+
+	detail::flush(s);
+
+	return BLINK_OK;
+}
+
+//
+// Events recorded by a process call which is still running when this is
+// called may be lost, so ideally stop processing first
+//
+inline blink_Error end()
+{
+	auto& s = detail::session();
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+
+	if (!s.file) return blink_StdError_NotInitialized;
+
+	detail::buffer().set_recording(false);
+	detail::flush(s);
+
+	std::fprintf(s.file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%llu}}\n", (unsigned long long)(s.num_dropped));
+	std::fclose(s.file);
+
+	s.file = nullptr;
+
+	return BLINK_OK;
+}
+
+}}
+
+#else
+
+namespace blink {
+namespace trace {
+
+struct Scope { Scope(const char*, const void*, std::uint64_t) {} };
+
+inline void counter(const char*, std::uint64_t, float) {}
+
+inline blink_Error begin(const char*) { return blink_StdError_NotImplemented; }
+inline blink_Error flush() { return blink_StdError_NotImplemented; }
+inline blink_Error end() { return blink_StdError_NotImplemented; }
+
+}}
+
+#endif
@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <blink.h>
+#include "bits.hpp"
 #include "block_positions.hpp"
+#include "profile.hpp"
 
 #pragma warning(push, 0)
 #include <DSP/MLDSPOps.h>
@@ -26,29 +28,93 @@ public:
 	void generate(const BlockPositions& block_positions, int n = kFloatsPerDSPVector)
 	{
 		block_positions_ = &block_positions;
-		reset_ = 0;
 
-		auto position = block_positions.prev_pos;
+		//
+		// Each position is compared against the one before it (the vector
+		// shifted right by one.) There are no branches so the compiler is
+		// able to vectorize both loops
+		//
+		const auto& positions = block_positions.fixed_positions.values;
+
+		std::int64_t prev_positions[kFloatsPerDSPVector];
+
+		prev_positions[0] = block_positions.fixed_prev_pos.value;
+
+		for (int i = 1; i < kFloatsPerDSPVector; i++)
+		{
+			prev_positions[i] = positions[i - 1];
+		}
+
+		std::uint64_t mask = 0;
 
 		for (int i = 0; i < n; i++)
 		{
-			if (block_positions.positions[i] < position)
-			{
-				reset_[i] = 1;
-			}
+			mask |= std::uint64_t(positions[i] < prev_positions[i]) << i;
+		}
+
+		reset_mask_ = mask;
 
-			position = block_positions.positions[i];
+		profile::count_resets(bits::count_set_bits(mask));
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			reset_[i] = int((mask >> i) & 1);
 		}
 	}
 
+	//
+	// Returns the index of the first position after [index] which either has a
+	// reset event or falls outside of the range [min, max)
+	//
+	// Traversers use this to find runs of positions which can be evaluated in
+	// one go because they all lie within the same envelope segment
+	//
+	int get_run_end(int index, int count, blink_Position min, blink_Position max) const
+	{
+		const auto& positions = block_positions_->fixed_positions;
+
+		index++;
+
+		if (reset_mask_ != 0 && index < kFloatsPerDSPVector)
+		{
+			const auto next_reset = bits::find_first_set((reset_mask_ >> index) << index);
+
+			if (next_reset < count) count = next_reset;
+		}
+
+		for (; index < count; index++)
+		{
+			const blink_Position position = positions[index];
+
+			if (position < min || position >= max) break;
+		}
+
+		return index;
+	}
+
 	const BlockPositions& block_positions() const { return *block_positions_; }
 	const ml::DSPVectorInt& get_resets() const { return reset_; }
-	void set_reset(int index) { reset_[index] = 1; }
+
+	// Bit i is set if there is a reset at position i
+	std::uint64_t get_reset_mask() const { return reset_mask_; }
+
+	// Traversers can skip checking for resets altogether if this is false,
+	// which is almost always the case
+	bool has_resets() const { return reset_mask_ != 0; }
+
+	bool is_reset(int index) const { return bits::check(reset_mask_, std::uint64_t(index)); }
+
+	void set_reset(int index)
+	{
+		reset_[index] = 1;
+		reset_mask_ |= std::uint64_t(1) << index;
+	}
 
 private:
 
 	const BlockPositions* block_positions_;
 	ml::DSPVectorInt reset_;
+	std::uint64_t reset_mask_ = 0;
 };
 
 //
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <map>
 #include "block_positions.hpp"
 #include "envelope_spec.hpp"
@@ -7,12 +8,17 @@
 #include "parameter.hpp"
 #include "slider_spec.hpp"
 #include "envelope_parameter.hpp"
+#include "intrusive_list.hpp"
+#include "parameter_changes.hpp"
+#include "profile.hpp"
+#include "trace.hpp"
 
 namespace blink {
 
 class Instance;
 
 extern blink_SR get_SR(Instance*);
+extern int get_num_parameters(Instance*);
 
 class Unit
 {
@@ -20,7 +26,8 @@ class Unit
 public:
 
 	Unit(Instance* instance)
-		: instance_(instance)
+		: parameter_changes_(get_num_parameters(instance))
+		, instance_(instance)
 	{
 	}
 
@@ -32,6 +39,43 @@ public:
 	int get_num_channels() const { return 2; }
 	Instance* get_instance() const { return instance_; }
 
+	//
+	// Inactive units should hold on to as little memory as possible. When a
+	// unit is activated again reset_after_activate() is called before the
+	// next vector is processed.
+	//
+	// Call these from a non-audio thread. Processing an inactive unit fails
+	// with blink_StdError_UnitInactive rather than activating it, because
+	// on_activate() may allocate
+	//
+	void activate();
+	void deactivate();
+	bool is_active() const { return active_; }
+
+	// State of the output of the most recent process call
+	blink_OutputState get_output_state() const { return output_state_; }
+
+	// See blink_set_parameter_generations(). Called from a non-audio thread
+	void set_parameter_generations(const std::uint64_t* generations)
+	{
+		parameter_generations_ = generations;
+		parameter_changes_.invalidate();
+	}
+
+	// Profiling statistics since the last call (see profile.hpp). Call from
+	// one non-audio thread only. Everything is zero unless the plugin was
+	// built with BLINK_PROFILE
+	void get_profile_stats(blink_ProfileStats* out) { profile_.get_stats(out); }
+
+	// Samples with a magnitude at or below this are treated as silent
+	static constexpr float SILENCE_THRESHOLD = 1.0e-6f;
+
+	static bool is_silent(const float* buffer, int size, float threshold = SILENCE_THRESHOLD);
+	static bool is_silent(const ml::DSPVector& vec, float threshold = SILENCE_THRESHOLD);
+
+	// [out] is one vector of non-interleaved stereo output
+	static blink_OutputState detect_output_state(const float* out, float threshold = SILENCE_THRESHOLD);
+
 	static ml::DSPVectorArray<2> stereo_pan(
 		const ml::DSPVectorArray<2> in,
 		float pan,
@@ -44,36 +88,204 @@ protected:
 	blink_SR SR() const { return get_SR(instance_); }
 
 	void begin_process(std::uint64_t buffer_id, const blink_Position* positions, int data_offset)
+	{
+		begin_process(buffer_id, 1);
+		set_positions(positions, data_offset);
+	}
+
+	//
+	// For processing [num_vectors] vectors in one go. set_positions() should
+	// then be called before each vector is processed. [num_vectors] must be
+	// at least 1 (the process wrappers reject anything less)
+	//
+	void begin_process(std::uint64_t buffer_id, int num_vectors)
 	{
 		//
 		// Unit::reset() is called at the start of the buffer if we have gone
-		// at least one buffer without processing this unit
+		// at least one buffer without processing this unit, unless the unit
+		// has just been activated again, in which case the cheaper
+		// reset_after_activate() is called instead
 		//
 
-		if (buffer_id > buffer_id_ + 1)
+		if (reset_pending_)
 		{
+			trace::Scope trace_scope("Unit::reset_after_activate", this, buffer_id);
+
+			reset_after_activate();
+
+			reset_pending_ = false;
+		}
+		else if (buffer_id > buffer_id_ + 1)
+		{
+			trace::Scope trace_scope("Unit::reset", this, buffer_id);
+
 			reset();
 		}
 
-		buffer_id_ = buffer_id;
+		buffer_id_ = buffer_id + num_vectors - 1;
+	}
 
+	void set_positions(const blink_Position* positions, int data_offset)
+	{
 		block_positions_(positions, data_offset, kFloatsPerDSPVector);
 	}
 
+	//
+	// Plugins which already know the state of their output (e.g. because
+	// they skipped processing altogether) can call this from process().
+	// Otherwise the state is detected from the output buffer.
+	//
+	// The output buffer must still be filled in. A plugin which reports
+	// blink_OutputState_Silent has to write zeros to it, because the host
+	// may mix it anyway
+	//
+	void set_output_state(blink_OutputState state)
+	{
+		vector_output_state_ = state;
+		vector_output_state_set_ = true;
+	}
+
+	void begin_vector()
+	{
+		vector_output_state_set_ = false;
+	}
+
+	void end_vector(const float* out, int vector_index)
+	{
+		const auto state = vector_output_state_set_ ? vector_output_state_ : detect_output_state(out);
+
+		if (vector_index == 0)
+		{
+			output_state_ = state;
+		}
+		else if (state != blink_OutputState_Silent || output_state_ != blink_OutputState_Silent)
+		{
+			output_state_ = blink_OutputState_Active;
+		}
+	}
+
 	const BlockPositions& block_positions() const
 	{
 		return block_positions_;
 	}
 
+	// The process wrappers time each call with a profile::CallScope
+	profile::UnitProfile& profile() { return profile_; }
+
+	// Which parameters changed since the previous call to process()
+	const ParameterChanges& parameter_changes() const
+	{
+		return parameter_changes_;
+	}
+
+	void update_parameter_changes()
+	{
+		parameter_changes_.update(parameter_generations_);
+	}
+
 private:
 
+	friend class Instance;
+
 	virtual void reset() = 0;
 
+	// Can be overridden to allocate and free scratch memory. Called from a
+	// non-audio thread. reset_after_activate() will be called before
+	// processing resumes so there is no need to initialize anything here
+	virtual void on_activate() {}
+	virtual void on_deactivate() {}
+
+	// Called on the audio thread, instead of reset(), before the first
+	// vector after the unit is activated again. Anything which lives in the
+	// scratch memory on_activate() just handed out is being started from
+	// scratch anyway, so units can override this to reset only the state
+	// which was kept while they were inactive
+	virtual void reset_after_activate() { reset(); }
+
 	BlockPositions block_positions_;
+	ParameterChanges parameter_changes_;
+	const std::uint64_t* parameter_generations_ = nullptr;
+	profile::UnitProfile profile_;
 	Instance* instance_;
+	IntrusiveListHook<Unit> instance_hook_;
 	std::uint64_t buffer_id_ = 0;
+	blink_OutputState output_state_ = blink_OutputState_Active;
+	blink_OutputState vector_output_state_ = blink_OutputState_Active;
+	bool vector_output_state_set_ = false;
+	bool active_ = true;
+	bool reset_pending_ = false;
 };
 
+inline void Unit::activate()
+{
+	if (active_) return;
+
+	active_ = true;
+	reset_pending_ = true;
+
+	parameter_changes_.invalidate();
+
+	on_activate();
+}
+
+inline void Unit::deactivate()
+{
+	if (!active_) return;
+
+	active_ = false;
+
+	on_deactivate();
+}
+
+//
+// No early out so that the compiler is able to vectorize this. The
+// comparison is written so that a NaN counts as loud
+//
+inline bool Unit::is_silent(const float* buffer, int size, float threshold)
+{
+	bool loud = false;
+
+	for (int i = 0; i < size; i++)
+	{
+		loud |= !(std::abs(buffer[i]) <= threshold);
+	}
+
+	return !loud;
+}
+
+inline bool Unit::is_silent(const ml::DSPVector& vec, float threshold)
+{
+	return is_silent(vec.getConstBuffer(), kFloatsPerDSPVector, threshold);
+}
+
+//
+// Two passes over the output, one per channel, each checking for silence
+// and for a constant value at the same time. As with is_silent() there is
+// no early out, and NaNs count as both loud and changing so that a unit
+// producing them is always reported as active
+//
+inline blink_OutputState Unit::detect_output_state(const float* out, float threshold)
+{
+	bool loud = false;
+	bool changing = false;
+
+	for (int channel = 0; channel < 2; channel++)
+	{
+		const auto buffer = out + (channel * kFloatsPerDSPVector);
+		const auto first = buffer[0];
+
+		for (int i = 0; i < kFloatsPerDSPVector; i++)
+		{
+			loud |= !(std::abs(buffer[i]) <= threshold);
+			changing |= !(buffer[i] == first);
+		}
+	}
+
+	if (!loud) return blink_OutputState_Silent;
+
+	return changing ? blink_OutputState_Active : blink_OutputState_Constant;
+}
+
 inline ml::DSPVectorArray<2> Unit::stereo_pan(
 	const ml::DSPVectorArray<2> in,
 	float pan,
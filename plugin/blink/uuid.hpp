@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <blink.h>
+
+namespace blink {
+
+//
+// A UUID string parsed into 128 bits, so that UUIDs can be compared and
+// hashed without looking at the string again.
+//
+// Strings which aren't in the standard 8-4-4-4-12 hex format still get a
+// key, it is just a hash of the string instead
+//
+struct UUIDKey
+{
+	std::uint64_t hi = 0;
+	std::uint64_t lo = 0;
+
+	static UUIDKey from_string(blink_UUID uuid);
+
+	bool operator==(const UUIDKey& rhs) const { return hi == rhs.hi && lo == rhs.lo; }
+	bool operator!=(const UUIDKey& rhs) const { return !(*this == rhs); }
+
+	std::uint64_t hash() const
+	{
+		auto out = hi ^ (lo * 0x9E3779B97F4A7C15ULL);
+
+		out ^= out >> 32;
+
+		return out;
+	}
+};
+
+namespace uuid {
+
+inline int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+	return -1;
+}
+
+inline bool parse(blink_UUID uuid, UUIDKey* out)
+{
+	static constexpr int HYPHENS[] = { 8, 13, 18, 23 };
+
+	UUIDKey key;
+	int digits = 0;
+	int hyphen = 0;
+
+	for (int i = 0; uuid[i]; i++)
+	{
+		if (hyphen < 4 && i == HYPHENS[hyphen])
+		{
+			if (uuid[i] != '-') return false;
+
+			hyphen++;
+			continue;
+		}
+
+		const auto digit = hex_digit(uuid[i]);
+
+		if (digit < 0 || digits >= 32) return false;
+
+		auto& half = digits < 16 ? key.hi : key.lo;
+
+		half = (half << 4) | std::uint64_t(digit);
+		digits++;
+	}
+
+	if (digits != 32 || hyphen != 4) return false;
+
+	*out = key;
+
+	return true;
+}
+
+inline UUIDKey hash_string(blink_UUID uuid)
+{
+	// Two independent FNV-1a hashes
+	UUIDKey out { 14695981039346656037ULL, 0x84222325CBF29CE4ULL };
+
+	for (int i = 0; uuid[i]; i++)
+	{
+		out.hi = (out.hi ^ std::uint8_t(uuid[i])) * 1099511628211ULL;
+		out.lo = (out.lo ^ std::uint8_t(uuid[i])) * 0x100000001B3ULL + 1;
+	}
+
+	return out;
+}
+
+} // uuid
+
+inline UUIDKey UUIDKey::from_string(blink_UUID uuid)
+{
+	UUIDKey out;
+
+	if (uuid::parse(uuid, &out)) return out;
+
+	return uuid::hash_string(uuid);
+}
+
+//
+// Flat open addressing hash table keyed on UUIDs. Inserting may allocate,
+// finding never does
+//
+template <class T>
+class UUIDTable
+{
+public:
+
+	void insert(const UUIDKey& key, T value);
+	const T* find(const UUIDKey& key) const;
+	const T* find(blink_UUID uuid) const { return find(UUIDKey::from_string(uuid)); }
+
+	std::size_t size() const { return size_; }
+
+private:
+
+	struct Slot
+	{
+		UUIDKey key;
+		T value {};
+		bool used = false;
+	};
+
+	void grow();
+
+	std::vector<Slot> slots_;
+	std::size_t size_ = 0;
+};
+
+template <class T>
+inline void UUIDTable<T>::insert(const UUIDKey& key, T value)
+{
+	// Keep the load factor at or below one half
+	if ((size_ + 1) * 2 > slots_.size()) grow();
+
+	const auto mask = slots_.size() - 1;
+
+	for (auto index = key.hash() & mask;; index = (index + 1) & mask)
+	{
+		auto& slot = slots_[index];
+
+		if (!slot.used)
+		{
+			slot.key = key;
+			slot.value = std::move(value);
+			slot.used = true;
+			size_++;
+			return;
+		}
+
+		if (slot.key == key)
+		{
+			slot.value = std::move(value);
+			return;
+		}
+	}
+}
+
+template <class T>
+inline const T* UUIDTable<T>::find(const UUIDKey& key) const
+{
+	if (slots_.empty()) return nullptr;
+
+	const auto mask = slots_.size() - 1;
+
+	for (auto index = key.hash() & mask;; index = (index + 1) & mask)
+	{
+		const auto& slot = slots_[index];
+
+		if (!slot.used) return nullptr;
+		if (slot.key == key) return &slot.value;
+	}
+}
+
+template <class T>
+inline void UUIDTable<T>::grow()
+{
+	auto old_slots = std::move(slots_);
+
+	slots_.clear();
+	slots_.resize(old_slots.empty() ? 16 : old_slots.size() * 2);
+	size_ = 0;
+
+	for (auto& slot : old_slots)
+	{
+		if (slot.used) insert(slot.key, std::move(slot.value));
+	}
+}
+
+}
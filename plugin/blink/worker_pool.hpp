@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace blink {
+
+//
+// A small fixed size pool of threads for splitting work up into tasks.
+//
+// run() hands out task indices [0, num_tasks) to the workers and the calling
+// thread and only returns once every task has finished. Only one run() may
+// be in progress at a time.
+//
+// Not for use in the audio thread
+//
+class WorkerPool
+{
+public:
+
+	WorkerPool(int num_threads = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Total number of threads which work on tasks, including the caller of run()
+	int get_num_threads() const { return int(threads_.size()) + 1; }
+
+	void run(int num_tasks, std::function<void(int)> task);
+
+private:
+
+	void worker();
+	void do_tasks();
+
+	std::vector<std::thread> threads_;
+
+	std::mutex mutex_;
+	std::condition_variable work_cv_;
+	std::condition_variable done_cv_;
+
+	std::function<void(int)> task_;
+	int num_tasks_ = 0;
+	int num_tasks_done_ = 0;
+	int num_active_workers_ = 0;
+	std::atomic<int> next_task_ { 0 };
+	std::uint64_t generation_ = 0;
+	bool quit_ = false;
+};
+
+inline WorkerPool::WorkerPool(int num_threads)
+{
+	for (int i = 0; i < num_threads; i++)
+	{
+		threads_.emplace_back([this]() { worker(); });
+	}
+}
+
+inline WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		quit_ = true;
+	}
+
+	work_cv_.notify_all();
+
+	for (auto& thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+inline void WorkerPool::run(int num_tasks, std::function<void(int)> task)
+{
+	if (num_tasks < 1) return;
+
+	if (threads_.empty() || num_tasks == 1)
+	{
+		for (int i = 0; i < num_tasks; i++) task(i);
+
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		//
+		// Workers which woke up too late for the previous run may still be
+		// on their way out
+		//
+		done_cv_.wait(lock, [this]() { return num_active_workers_ == 0; });
+
+		task_ = std::move(task);
+		num_tasks_ = num_tasks;
+		num_tasks_done_ = 0;
+		next_task_ = 0;
+		generation_++;
+	}
+
+	work_cv_.notify_all();
+
+	do_tasks();
+
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	done_cv_.wait(lock, [this]() { return num_tasks_done_ >= num_tasks_ && num_active_workers_ == 0; });
+
+	task_ = nullptr;
+}
+
+inline void WorkerPool::do_tasks()
+{
+	for (;;)
+	{
+		const auto index = next_task_++;
+
+		if (index >= num_tasks_) return;
+
+		task_(index);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		num_tasks_done_++;
+	}
+}
+
+inline void WorkerPool::worker()
+{
+	std::uint64_t generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+
+			work_cv_.wait(lock, [&]() { return quit_ || generation_ != generation; });
+
+			if (quit_) return;
+
+			generation = generation_;
+			num_active_workers_++;
+		}
+
+		do_tasks();
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		num_active_workers_--;
+		done_cv_.notify_all();
+	}
+}
+
+}